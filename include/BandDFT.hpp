@@ -0,0 +1,170 @@
+#pragma once
+#include <vector>
+#include <complex>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "FFT.hpp"
+#include "Parallel.hpp"
+
+// --- Band-Limited DFT ---
+// Evaluates only the requested bins of X[k] = sum_n x[n] * e^(-2*pi*i*k*n/N).
+// Two strategies, picked from a flop estimate:
+//
+//   Goertzel  O(N) per bin. Best for a handful of bins.
+//   Pruned    Decimation in time with N = P * Q: P strided sub-FFTs of
+//             length Q (N log Q total), then each wanted bin combines
+//             the P sub-spectra (P per bin). With Q close to the band
+//             size this is ~N log B instead of N log N, and Q = N is the
+//             plain full FFT.
+class BandDFT {
+public:
+    using cpx = std::complex<double>;
+
+    enum class Method { Auto, Goertzel, Pruned };
+
+    // out[i] = X[bins[i]] for bins[i] < N.
+    static void Compute(const cpx* x, size_t N, const std::vector<size_t>& bins, cpx* out,
+                        unsigned threads = 1, Method method = Method::Auto) {
+        if (N == 0 || bins.empty()) return;
+
+        size_t Q = BestSubLength(N, bins.size());
+        if (method == Method::Auto) {
+            const double goertzel = (double)bins.size() * (double)N * GOERTZEL_COST;
+            method = goertzel <= PrunedCost(N, Q, bins.size()) ? Method::Goertzel : Method::Pruned;
+        }
+
+        if (method == Method::Goertzel) Goertzel(x, N, bins, out, threads);
+        else Pruned(x, N, Q, bins, out, threads);
+    }
+
+    // Method Compute() would use (for logs and benchmarks).
+    static Method Choose(size_t N, size_t binCount) {
+        const double goertzel = (double)binCount * (double)N * GOERTZEL_COST;
+        return goertzel <= PrunedCost(N, BestSubLength(N, binCount), binCount) ? Method::Goertzel : Method::Pruned;
+    }
+
+private:
+    // Relative cost of one Goertzel step per bin (4 bins interleaved)
+    // against one FFT butterfly level per point, measured at N = 1e4..1e5.
+    static constexpr double GOERTZEL_COST = 0.45;
+    static constexpr size_t GOERTZEL_GROUP = 4;
+    static constexpr size_t GOERTZEL_BLOCK = 1024;
+    static constexpr double BLUESTEIN_PENALTY = 4.0;
+
+    static double FFTCost(size_t n) {
+        double cost = (double)n * std::log2((double)std::max<size_t>(n, 2));
+        return LargestPrime(n) > FFTPlan::MAX_DIRECT_RADIX ? cost * BLUESTEIN_PENALTY : cost;
+    }
+
+    static double PrunedCost(size_t N, size_t Q, size_t binCount) {
+        const size_t P = N / Q;
+        return (double)P * FFTCost(Q) + (double)binCount * (double)P;
+    }
+
+    static size_t LargestPrime(size_t n) {
+        size_t largest = 1;
+        for (size_t p = 2; p * p <= n; ++p) {
+            while (n % p == 0) { largest = p; n /= p; }
+        }
+        return std::max(largest, n);
+    }
+
+    // Divisor Q of N minimizing the pruned cost.
+    static size_t BestSubLength(size_t N, size_t binCount) {
+        size_t best = N;
+        double bestCost = PrunedCost(N, N, binCount);
+        for (size_t d = 1; d * d <= N; ++d) {
+            if (N % d != 0) continue;
+            for (size_t Q : {d, N / d}) {
+                double cost = PrunedCost(N, Q, binCount);
+                if (cost < bestCost) { bestCost = cost; best = Q; }
+            }
+        }
+        return best;
+    }
+
+    // Goertzel with a complex state: s[n] = x[n] + 2cos(w) s[n-1] - s[n-2],
+    // then sum_m x[m] e^(-iwm) = e^(-iwL) (e^(iw) s[L-1] - s[L-2]) over a
+    // block of L samples. Rounding in the recurrence grows with the square
+    // of its length, so it restarts every GOERTZEL_BLOCK samples and the
+    // blocks are combined with their start phase. GOERTZEL_GROUP bins run
+    // interleaved to hide the recurrence's latency.
+    static void Goertzel(const cpx* x, size_t N, const std::vector<size_t>& bins, cpx* out, unsigned threads) {
+        const size_t groups = (bins.size() + GOERTZEL_GROUP - 1) / GOERTZEL_GROUP;
+        Parallel::For(0, groups, threads, 1, [&](size_t lo, size_t hi) {
+            for (size_t g = lo; g < hi; ++g) {
+                const size_t first = g * GOERTZEL_GROUP;
+                const size_t count = std::min(GOERTZEL_GROUP, bins.size() - first);
+
+                double coeff[GOERTZEL_GROUP] = {}, w[GOERTZEL_GROUP] = {};
+                cpx acc[GOERTZEL_GROUP];
+                for (size_t j = 0; j < count; ++j) {
+                    w[j] = 2.0 * M_PI * (double)bins[first + j] / (double)N;
+                    coeff[j] = 2.0 * std::cos(w[j]);
+                }
+
+                for (size_t start = 0; start < N; start += GOERTZEL_BLOCK) {
+                    const size_t L = std::min(GOERTZEL_BLOCK, N - start);
+                    double s1Re[GOERTZEL_GROUP] = {}, s1Im[GOERTZEL_GROUP] = {};
+                    double s2Re[GOERTZEL_GROUP] = {}, s2Im[GOERTZEL_GROUP] = {};
+                    for (size_t m = 0; m < L; ++m) {
+                        const double xRe = x[start + m].real(), xIm = x[start + m].imag();
+                        for (size_t j = 0; j < GOERTZEL_GROUP; ++j) {
+                            const double re = xRe + coeff[j] * s1Re[j] - s2Re[j];
+                            const double im = xIm + coeff[j] * s1Im[j] - s2Im[j];
+                            s2Re[j] = s1Re[j]; s2Im[j] = s1Im[j];
+                            s1Re[j] = re; s1Im[j] = im;
+                        }
+                    }
+                    for (size_t j = 0; j < count; ++j) {
+                        const cpx y = std::polar(1.0, w[j]) * cpx(s1Re[j], s1Im[j]) - cpx(s2Re[j], s2Im[j]);
+                        // Reduce k * (start + L) mod N before scaling so the angle stays exact
+                        const size_t turns = (bins[first + j] * (start + L)) % N;
+                        acc[j] += std::polar(1.0, -2.0 * M_PI * (double)turns / (double)N) * y;
+                    }
+                }
+                for (size_t j = 0; j < count; ++j) out[first + j] = acc[j];
+            }
+        });
+    }
+
+    // x[q * P + p] for fixed p is a length-Q signal with spectrum Y_p, and
+    // X[k] = sum_p e^(-2*pi*i*p*k/N) * Y_p[k mod Q] (Horner over p).
+    static void Pruned(const cpx* x, size_t N, size_t Q, const std::vector<size_t>& bins, cpx* out,
+                       unsigned threads) {
+        const size_t P = N / Q;
+        if (P == 1) {
+            std::vector<cpx> full(N);
+            FFTPlan::Get(N)->Forward(x, full.data(), threads);
+            for (size_t b = 0; b < bins.size(); ++b) out[b] = full[bins[b]];
+            return;
+        }
+
+        auto plan = FFTPlan::Get(Q);
+        std::vector<cpx> sub(N);  // sub[p * Q + k] = Y_p[k]
+        Parallel::For(0, P, threads, 1, [&](size_t lo, size_t hi) {
+            std::vector<cpx> strided(Q);
+            for (size_t p = lo; p < hi; ++p) {
+                for (size_t q = 0; q < Q; ++q) strided[q] = x[q * P + p];
+                plan->Forward(strided.data(), sub.data() + p * Q);
+            }
+        });
+
+        Parallel::For(0, bins.size(), threads, 16, [&](size_t lo, size_t hi) {
+            for (size_t b = lo; b < hi; ++b) {
+                const size_t k = bins[b];
+                const size_t kq = k % Q;
+                const double angle = -2.0 * M_PI * (double)k / (double)N;
+                const cpx r(std::cos(angle), std::sin(angle));
+                cpx acc = sub[(P - 1) * Q + kq];
+                for (size_t p = P - 1; p-- > 0;) {
+                    acc = cpx(acc.real() * r.real() - acc.imag() * r.imag() + sub[p * Q + kq].real(),
+                              acc.real() * r.imag() + acc.imag() * r.real() + sub[p * Q + kq].imag());
+                }
+                out[b] = acc;
+            }
+        });
+    }
+};
@@ -0,0 +1,271 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstring>
+#include <cmath>
+#include <thread>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <glm/glm.hpp>
+
+#include "FourierCore.hpp"
+#include "SVGParser.hpp"
+#include "SpectrumCodec.hpp"
+
+// --- Command-Line Benchmarks ---
+// Headless perf reports, run before any window or GL context is created.
+class Benchmark {
+public:
+    // Synthetic closed curve with plenty of harmonics.
+    static std::vector<glm::vec2> TestPath(size_t n) {
+        std::vector<glm::vec2> path(n);
+        for (size_t i = 0; i < n; ++i) {
+            float t = (float)(2.0 * M_PI * (double)i / (double)n);
+            path[i] = glm::vec2(300.0f * std::cos(t) + 80.0f * std::cos(7.0f * t) + 15.0f * std::sin(41.0f * t),
+                                250.0f * std::sin(3.0f * t) + 60.0f * std::sin(11.0f * t));
+        }
+        return path;
+    }
+
+    template<typename Fn>
+    static double BestOfMs(int runs, Fn&& fn) {
+        double best = 1e30;
+        for (int r = 0; r < runs; ++r) {
+            auto t0 = std::chrono::steady_clock::now();
+            fn();
+            auto t1 = std::chrono::steady_clock::now();
+            best = std::min(best, std::chrono::duration<double, std::milli>(t1 - t0).count());
+        }
+        return best;
+    }
+
+    // ComputeDFT speedup per thread count, checked bit-for-bit
+    // against the single-threaded result.
+    static void DFTScaling(const std::vector<size_t>& sizes) {
+        unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+        std::vector<unsigned> counts;
+        for (unsigned t = 1; t < hw; t *= 2) counts.push_back(t);
+        counts.push_back(hw);
+
+        for (size_t n : sizes) {
+            auto path = TestPath(n);
+            auto reference = FourierTransform::ComputeDFT(path, 1);  // also warms the plan cache
+            double baseMs = 0.0;
+
+            std::cout << "ComputeDFT N=" << n << " (" << hw << " hardware threads)\n";
+            std::cout << "  threads    time(ms)   speedup   identical\n";
+            for (unsigned t : counts) {
+                std::vector<Epicycle> result;
+                double ms = BestOfMs(5, [&]() { result = FourierTransform::ComputeDFT(path, t); });
+                if (t == 1) baseMs = ms;
+
+                bool identical = result.size() == reference.size();
+                for (size_t i = 0; identical && i < result.size(); ++i) {
+                    identical = std::memcmp(&result[i].value, &reference[i].value, sizeof(result[i].value)) == 0 &&
+                                result[i].frequency == reference[i].frequency;
+                }
+
+                std::cout << "  " << std::setw(7) << t
+                          << std::setw(12) << std::fixed << std::setprecision(3) << ms
+                          << std::setw(9) << std::setprecision(2) << baseMs / ms << "x"
+                          << std::setw(12) << (identical ? "yes" : "NO") << "\n";
+            }
+        }
+    }
+
+    // Per-frame chain cost (5 substeps + one chain prefix pass, as in the
+    // physics loop) for each SIMD level this CPU supports.
+    static void ChainThroughput(size_t count) {
+        auto epis = FourierTransform::ComputeDFT(TestPath(count));
+        const double dt = 0.05 * 0.002 / 5.0;
+        Simd::Level detected = Simd::Detected();
+
+        std::cout << "Epicycle chain, " << epis.size() << " circles\n";
+        std::cout << "  ISA        frame(ms)   max fps\n";
+        for (int level = 0; level <= (int)detected; ++level) {
+            Simd::SetLevel((Simd::Level)level);
+            PhasorEvaluator phasors;
+            phasors.Reset(epis);
+            phasors.Advance(dt);
+
+            std::complex<double> tip;
+            double ms = BestOfMs(5, [&]() {
+                for (int frame = 0; frame < 20; ++frame) {
+                    for (int s = 0; s < 5; ++s) {
+                        phasors.Advance(dt);
+                        tip += phasors.Sum(epis.size());
+                    }
+                    phasors.ComputeChain(epis.size());
+                }
+            }) / 20.0;
+
+            std::cout << "  " << std::left << std::setw(9) << Simd::Name((Simd::Level)level) << std::right
+                      << std::setw(11) << std::fixed << std::setprecision(3) << ms
+                      << std::setw(10) << std::setprecision(0) << 1000.0 / ms << "\n";
+        }
+        Simd::SetLevel(detected);
+    }
+
+    // Icon sheet with the styling that weighs on a full parse: a CSS block,
+    // gradients, and per-element fill/stroke/style attributes, around
+    // transformed groups of paths and basic shapes. Written to the temp
+    // directory; returns its path.
+    static std::string StyledCorpus(int icons) {
+        std::ostringstream svg;
+        svg << "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"4000\" height=\"4000\">\n"
+            << "<style>.ink{fill:url(#shade);stroke:#223344;stroke-width:1.5;stroke-linejoin:round}"
+            << " .hi{opacity:0.6;fill:#ffeecc}</style>\n<defs>\n";
+        for (int g = 0; g < 16; ++g) {
+            svg << "<linearGradient id=\"shade" << g << "\" x1=\"0\" y1=\"0\" x2=\"1\" y2=\"1\">"
+                << "<stop offset=\"0\" stop-color=\"#" << std::hex << (0x102030 * (g + 1) & 0xffffff) << std::dec
+                << "\"/><stop offset=\"1\" stop-color=\"rgb(20,40," << g * 15 << ")\" stop-opacity=\"0.8\"/>"
+                << "</linearGradient>\n";
+        }
+        svg << "</defs>\n";
+        for (int i = 0; i < icons; ++i) {
+            const int x = (i % 64) * 60, y = (i / 64) * 60;
+            svg << "<g transform=\"translate(" << x << " " << y << ") rotate(" << (i * 7) % 360 << " 25 25)\""
+                << " style=\"fill:url(#shade" << i % 16 << ");stroke:#000;stroke-width:0.5;fill-rule:evenodd\">\n"
+                << "  <path class=\"ink\" fill=\"url(#shade" << (i + 3) % 16 << ")\" stroke-dasharray=\"2 1\""
+                << " d=\"M5 25 C5 10 20 5 25 5 S45 10 45 25 Q45 45 25 45 T5 25 Z"
+                << " m8 0 a12 12 0 1 0 24 0 a12 12 0 1 0 -24 0 z\"/>\n"
+                << "  <rect class=\"hi\" x=\"10\" y=\"30\" width=\"30\" height=\"12\" rx=\"4\""
+                << " style=\"stroke:rgba(0,0,0,0.4);stroke-width:2px\"/>\n"
+                << "  <circle cx=\"25\" cy=\"18\" r=\"6\" fill=\"#" << std::hex << (0xabcdef ^ i) % 0xffffff << std::dec
+                << "\" stroke=\"none\" opacity=\"0.9\"/>\n"
+                << "  <polygon points=\"20,40 25,48 30,40\" fill=\"hsl(" << i % 360 << ", 50%, 50%)\"/>\n"
+                << "</g>\n";
+        }
+        svg << "</svg>\n";
+
+        const std::string path = (std::filesystem::temp_directory_path() / "fourier-forge-styled.svg").string();
+        std::ofstream(path) << svg.str();
+        return path;
+    }
+
+    // Parse time of the full nanosvg front end against the geometry-only
+    // one, each followed by a walk over every segment, plus the segment
+    // counts each produced. Full reports more on the styled corpus: nanosvg
+    // adds a zero-length closing segment to closed shapes and cuts arcs into
+    // finer pieces.
+    static void SVGParse(std::vector<std::string> files) {
+        if (files.empty()) files.push_back(StyledCorpus(4096));
+
+        std::cout << "SVG parse (segments walked once after parsing)\n";
+        std::cout << "  file                       full(ms)  geometry(ms)   speedup   segments full/geometry\n";
+        for (const auto& file : files) {
+            size_t segments[2] = {};
+            double ms[2];
+            const SVGParser::ParseMode modes[2] = { SVGParser::ParseMode::Full, SVGParser::ParseMode::Geometry };
+            for (int m = 0; m < 2; ++m) {
+                std::streambuf* log = std::cout.rdbuf(nullptr);  // silence per-parse logging
+                ms[m] = BestOfMs(5, [&]() {
+                    segments[m] = 0;
+                    SVGParser::WithSource(file, modes[m], [&](const auto& source) {
+                        for (size_t chunk = 0; chunk < source.Chunks(); ++chunk) {
+                            source.Segments(chunk, [&](const Cubic&) { ++segments[m]; });
+                        }
+                    });
+                });
+                std::cout.rdbuf(log);
+            }
+
+            const std::string name = std::filesystem::path(file).filename().string();
+            std::cout << "  " << std::left << std::setw(25) << name.substr(0, 25) << std::right
+                      << std::setw(10) << std::fixed << std::setprecision(2) << ms[0]
+                      << std::setw(14) << ms[1]
+                      << std::setw(9) << std::setprecision(1) << ms[0] / ms[1] << "x"
+                      << std::setw(15) << segments[0] << "/" << segments[1] << "\n";
+        }
+    }
+
+    // Circles a joined outline needs for a few RMS targets (in normalized
+    // units, like the "Keep" control) with subpaths in document order and
+    // in SubpathOrder's order, sampled as a load would sample them.
+    static void SubpathReorder(std::vector<std::string> files) {
+        if (files.empty()) files.push_back(StyledCorpus(256));
+        const double targets[3] = { 2.0, 1.0, 0.5 };
+
+        for (const auto& file : files) {
+            std::streambuf* log = std::cout.rdbuf(nullptr);
+            std::vector<std::vector<Cubic>> subpaths = SVGParser::LoadSubpaths(file);
+            std::cout.rdbuf(log);
+            if (subpaths.empty()) continue;
+
+            std::vector<std::vector<Cubic>> ordered;
+            SubpathOrder::Result travel;
+            const double ms = BestOfMs(1, [&]() {
+                ordered = subpaths;
+                travel = SubpathOrder::Optimize(ordered);
+            });
+            const auto before = OutlineSampler::Sample(OutlineSampler::SubpathList{ subpaths }, 10000, 0.1,
+                                                       SVGParser::NORMALIZED_SIZE);
+            const auto after = OutlineSampler::Sample(OutlineSampler::SubpathList{ ordered }, 10000, 0.1,
+                                                      SVGParser::NORMALIZED_SIZE);
+
+            std::cout << "Subpath order: " << std::filesystem::path(file).filename().string() << " ("
+                      << subpaths.size() << " subpaths, optimized in " << std::fixed << std::setprecision(2) << ms
+                      << " ms)\n";
+            std::cout << "  jumps (source units)  " << std::setprecision(1) << travel.before << " -> "
+                      << travel.after << "\n";
+            std::cout << "  RMS target   circles before   after\n";
+            for (double target : targets) {
+                const size_t was = FourierTransform::ComputeDFT(before, 0, Fidelity::RMS(target)).size();
+                const size_t now = FourierTransform::ComputeDFT(after, 0, Fidelity::RMS(target)).size();
+                std::cout << "  " << std::setw(10) << std::setprecision(1) << target
+                          << std::setw(17) << was << std::setw(8) << now << "\n";
+            }
+        }
+    }
+
+    // SpectrumCodec size, error and speed per bit depth, on the spectrum a
+    // load would compute (adaptive sample count). "raw read" reads the
+    // 32-byte-per-coefficient Epicycle array back from a temp file, which
+    // the page cache usually holds, so it is a lower bound on disk time.
+    static void Codec(std::vector<std::string> files) {
+        if (files.empty()) files.push_back(StyledCorpus(256));
+        const int depths[3][2] = { { 8, 8 }, { 12, 12 }, { 16, 16 } };
+
+        for (const auto& file : files) {
+            std::streambuf* log = std::cout.rdbuf(nullptr);
+            const auto points = SVGParser::LoadAndSample(file, SVGParser::ADAPTIVE);
+            std::cout.rdbuf(log);
+            if (points.empty()) continue;
+            const auto spectrum = FourierTransform::ComputeDFT(points);
+
+            const std::string raw = (std::filesystem::temp_directory_path() / "fourier-forge-raw.bin").string();
+            std::ofstream(raw, std::ios::binary)
+                .write((const char*)spectrum.data(), (std::streamsize)(spectrum.size() * sizeof(Epicycle)));
+            std::vector<Epicycle> readBack(spectrum.size());
+            const double rawMs = BestOfMs(5, [&]() {
+                std::ifstream in(raw, std::ios::binary);
+                in.read((char*)readBack.data(), (std::streamsize)(readBack.size() * sizeof(Epicycle)));
+            });
+            std::filesystem::remove(raw);
+
+            std::cout << "Spectrum codec: " << std::filesystem::path(file).filename().string() << " ("
+                      << spectrum.size() << " coefficients, " << spectrum.size() * sizeof(Epicycle) / 1024
+                      << " KB raw, read " << std::fixed << std::setprecision(3) << rawMs << " ms)\n";
+            std::cout << "  bits a/p   bytes/coef   encode(ms)  decode(ms)   RMS(px)   peak(px)  dropped\n";
+            for (const auto& d : depths) {
+                std::vector<uint8_t> blob;
+                SpectrumCodec::Error error;
+                const double encodeMs = BestOfMs(3, [&]() { blob = SpectrumCodec::Encode(spectrum, d[0], d[1], &error); });
+                std::vector<Epicycle> decoded;
+                const double decodeMs = BestOfMs(5, [&]() { SpectrumCodec::Decode(blob, decoded); });
+
+                std::cout << "  " << std::setw(4) << d[0] << "/" << std::left << std::setw(4) << d[1] << std::right
+                          << std::setw(12) << std::setprecision(2) << (double)blob.size() / spectrum.size()
+                          << std::setw(13) << std::setprecision(3) << encodeMs
+                          << std::setw(12) << decodeMs
+                          << std::setw(10) << std::setprecision(4) << error.rms
+                          << std::setw(11) << error.peak
+                          << std::setw(9) << error.dropped << "\n";
+            }
+        }
+    }
+};
@@ -0,0 +1,185 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <glm/glm.hpp>
+
+// --- Gauss-Legendre Quadrature ---
+// 8-point rule on [-1, 1]: exact for polynomials up to degree 15.
+struct GaussLegendre {
+    static constexpr int ORDER = 8;
+    static constexpr double NODES[ORDER] = {
+        -0.9602898564975363, -0.7966664774136267, -0.5255324099163290, -0.1834346424956498,
+         0.1834346424956498,  0.5255324099163290,  0.7966664774136267,  0.9602898564975363 };
+    static constexpr double WEIGHTS[ORDER] = {
+         0.1012285362903763,  0.2223810344533745,  0.3137066678688121,  0.3626837833783620,
+         0.3626837833783620,  0.3137066678688121,  0.2223810344533745,  0.1012285362903763 };
+
+    // Integral of fn over [a, b].
+    template<typename Fn>
+    static double Integrate(double a, double b, Fn&& fn) {
+        const double half = 0.5 * (b - a), mid = 0.5 * (a + b);
+        double sum = 0.0;
+        for (int i = 0; i < ORDER; ++i) sum += WEIGHTS[i] * fn(mid + half * NODES[i]);
+        return sum * half;
+    }
+};
+
+// --- Cubic Bezier Segment ---
+struct Cubic {
+    glm::dvec2 p0, p1, p2, p3;
+
+    static Cubic Line(glm::dvec2 a, glm::dvec2 b) {
+        return { a, a + (b - a) / 3.0, a + (b - a) * (2.0 / 3.0), b };
+    }
+
+    glm::dvec2 Point(double u) const {
+        const double v = 1.0 - u;
+        return v * v * v * p0 + 3.0 * v * v * u * p1 + 3.0 * v * u * u * p2 + u * u * u * p3;
+    }
+
+    glm::dvec2 Derivative(double u) const {
+        const double v = 1.0 - u;
+        return 3.0 * v * v * (p1 - p0) + 6.0 * v * u * (p2 - p1) + 3.0 * u * u * (p3 - p2);
+    }
+
+    double Speed(double u) const { return glm::length(Derivative(u)); }
+
+    // Arc length between parameters u0 and u1. The speed |B'| is not a
+    // polynomial, so the span is split before applying the 8-point rule.
+    double Length(double u0 = 0.0, double u1 = 1.0, int pieces = 4) const {
+        double total = 0.0;
+        const double step = (u1 - u0) / pieces;
+        for (int i = 0; i < pieces; ++i) {
+            total += GaussLegendre::Integrate(u0 + i * step, u0 + (i + 1) * step, [this](double u) { return Speed(u); });
+        }
+        return total;
+    }
+
+    // de Casteljau split at u: the curve is [0, u] then [u, 1].
+    std::pair<Cubic, Cubic> Split(double u) const {
+        const glm::dvec2 a = glm::mix(p0, p1, u), b = glm::mix(p1, p2, u), c = glm::mix(p2, p3, u);
+        const glm::dvec2 d = glm::mix(a, b, u), e = glm::mix(b, c, u);
+        const glm::dvec2 m = glm::mix(d, e, u);
+        return { Cubic{ p0, a, d, m }, Cubic{ m, e, c, p3 } };
+    }
+
+    // Parameters of sharp turns: local minima of the speed that drop below
+    // `ratio` times the average (cusps, tight loops). Position along the
+    // curve has a kink in arc length there, so quadrature should not
+    // straddle them.
+    std::vector<double> SharpTurns(double ratio = 0.1) const {
+        constexpr int SCAN = 64;
+        double speed[SCAN + 1], mean = 0.0, lowest = 1e300, highest = 0.0;
+        for (int i = 0; i <= SCAN; ++i) {
+            mean += speed[i] = Speed((double)i / SCAN);
+            lowest = std::min(lowest, speed[i]);
+            highest = std::max(highest, speed[i]);
+        }
+        mean /= SCAN + 1;
+
+        std::vector<double> turns;
+        if (highest - lowest <= 1e-9 * highest) return turns;  // constant speed (lines, joins)
+        for (int i = 1; i < SCAN; ++i) {
+            // A local minimum, strictly below at least one neighbour
+            if (speed[i] > speed[i - 1] || speed[i] > speed[i + 1]) continue;
+            if (speed[i] == speed[i - 1] && speed[i] == speed[i + 1]) continue;
+            // Golden-section refine on the bracketing samples
+            double lo = (double)(i - 1) / SCAN, hi = (double)(i + 1) / SCAN;
+            for (int iter = 0; iter < 40; ++iter) {
+                const double m1 = hi - 0.618033988749895 * (hi - lo), m2 = lo + 0.618033988749895 * (hi - lo);
+                if (Speed(m1) < Speed(m2)) hi = m2; else lo = m1;
+            }
+            const double u = 0.5 * (lo + hi);
+            if (Speed(u) < ratio * mean) turns.push_back(u);
+        }
+        return turns;
+    }
+
+    // Grows [lo, hi] to the exact bounds: endpoints plus the interior
+    // extrema, where a component of B'(u) (a quadratic) is zero.
+    void ExpandBounds(glm::dvec2& lo, glm::dvec2& hi) const {
+        lo = glm::min(lo, glm::min(p0, p3));
+        hi = glm::max(hi, glm::max(p0, p3));
+        for (int axis = 0; axis < 2; ++axis) {
+            // B'(u)/3 = a u^2 + b u + c
+            const double a = -p0[axis] + 3.0 * p1[axis] - 3.0 * p2[axis] + p3[axis];
+            const double b = 2.0 * (p0[axis] - 2.0 * p1[axis] + p2[axis]);
+            const double c = p1[axis] - p0[axis];
+
+            double roots[2];
+            int count = 0;
+            if (std::abs(a) < 1e-12) {
+                if (std::abs(b) > 1e-12) roots[count++] = -c / b;
+            } else {
+                const double disc = b * b - 4.0 * a * c;
+                if (disc >= 0.0) {
+                    const double sq = std::sqrt(disc);
+                    roots[count++] = (-b + sq) / (2.0 * a);
+                    roots[count++] = (-b - sq) / (2.0 * a);
+                }
+            }
+            for (int r = 0; r < count; ++r) {
+                if (roots[r] > 0.0 && roots[r] < 1.0) {
+                    const double v = Point(roots[r])[axis];
+                    lo[axis] = std::min(lo[axis], v);
+                    hi[axis] = std::max(hi[axis], v);
+                }
+            }
+        }
+    }
+
+    // Uniform steps in u needed for the chord polyline to stay within
+    // `tolerance` of the curve (Wang's formula): the second differences of
+    // the control points bound the curvature of the whole segment.
+    int FlattenSteps(double tolerance) const {
+        const double m = std::max(glm::length(p0 - 2.0 * p1 + p2), glm::length(p1 - 2.0 * p2 + p3));
+        const double steps = std::ceil(std::sqrt(0.75 * m / tolerance));
+        return (int)std::clamp(steps, 1.0, (double)MAX_FLATTEN_STEPS);
+    }
+
+    static constexpr int MAX_FLATTEN_STEPS = 4096;
+};
+
+// --- Arc Length Table ---
+// Cumulative length of one cubic at KNOTS equally spaced parameters (each
+// span by Gauss-Legendre), inverted with a few Newton steps so points can
+// be placed at exact arc-length positions.
+class ArcLengthTable {
+public:
+    static constexpr int KNOTS = 32;
+
+    explicit ArcLengthTable(const Cubic& c) : curve(c) {
+        cumulative[0] = 0.0;
+        for (int i = 0; i < KNOTS; ++i) {
+            cumulative[i + 1] = cumulative[i] + curve.Length((double)i / KNOTS, (double)(i + 1) / KNOTS, 1);
+        }
+    }
+
+    double Length() const { return cumulative[KNOTS]; }
+
+    // Parameter u where the arc length from u = 0 reaches s (clamped).
+    double ParamAt(double s) const {
+        if (s <= 0.0) return 0.0;
+        if (s >= cumulative[KNOTS]) return 1.0;
+        const int i = (int)(std::upper_bound(cumulative, cumulative + KNOTS + 1, s) - cumulative) - 1;
+        const double u0 = (double)i / KNOTS, u1 = (double)(i + 1) / KNOTS;
+        const double span = cumulative[i + 1] - cumulative[i];
+        const double target = s - cumulative[i];
+
+        double u = span > 0.0 ? u0 + (u1 - u0) * target / span : u0;
+        for (int iter = 0; iter < NEWTON_STEPS; ++iter) {
+            const double speed = curve.Speed(u);
+            if (speed <= 1e-12) break;
+            u = std::clamp(u - (curve.Length(u0, u, 1) - target) / speed, u0, u1);
+        }
+        return u;
+    }
+
+private:
+    static constexpr int NEWTON_STEPS = 3;
+
+    Cubic curve;
+    double cumulative[KNOTS + 1];
+};
@@ -0,0 +1,68 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <glm/glm.hpp>
+
+#include "FourierCore.hpp"
+
+// --- Epicycle Chain ---
+// Everything animated for one signal: its spectrum, the phasors behind the
+// drawn arms, the curve table behind the pen, and the ink it has left. A
+// drawing loaded as separate parts has one chain per part, all driven by
+// the same clock.
+struct Chain {
+    std::vector<glm::vec2> points;  // sampled outline (ghost reference)
+    std::vector<Epicycle> epis;     // largest circles first
+    PhasorEvaluator phasors;
+    CurveTable curve;
+    std::vector<glm::vec2> trail;
+    size_t count = 0;               // circles in use
+
+    Chain(std::vector<glm::vec2> outline, std::vector<Epicycle> spectrum)
+        : points(std::move(outline)), epis(std::move(spectrum)), count(epis.size()) {
+        phasors.Reset(epis);
+    }
+
+    // Splits a budget of `total` circles across chains: the `total` largest
+    // circles of the whole drawing are kept, wherever they are, which gives
+    // the lowest combined error for the budget. Every chain keeps at least
+    // its largest circle so its pen stays on the canvas.
+    static void Distribute(std::vector<Chain>& chains, size_t total) {
+        size_t available = 0;
+        for (const auto& c : chains) available += c.epis.size();
+        if (total >= available) {
+            for (auto& c : chains) c.count = c.epis.size();
+            return;
+        }
+        if (chains.size() == 1) {
+            chains[0].count = std::max<size_t>(1, total);
+            return;
+        }
+
+        std::vector<float> amps;
+        amps.reserve(available);
+        for (const auto& c : chains) {
+            for (const auto& e : c.epis) amps.push_back(e.amp);
+        }
+        const size_t k = std::max<size_t>(1, total) - 1;
+        std::nth_element(amps.begin(), amps.begin() + k, amps.end(), std::greater<float>());
+        const float threshold = amps[k];
+
+        // Circles above the threshold, then ties in chain order
+        size_t used = 0;
+        for (auto& c : chains) {
+            c.count = (size_t)(std::partition_point(c.epis.begin(), c.epis.end(),
+                                                    [&](const Epicycle& e) { return e.amp > threshold; }) - c.epis.begin());
+            used += c.count;
+        }
+        for (auto& c : chains) {
+            while (used < total && c.count < c.epis.size() && c.epis[c.count].amp >= threshold) {
+                ++c.count;
+                ++used;
+            }
+        }
+        for (auto& c : chains) c.count = std::max<size_t>(c.count, std::min<size_t>(1, c.epis.size()));
+    }
+};
@@ -0,0 +1,224 @@
+#pragma once
+#include <cstddef>
+#include <complex>
+
+#include "Simd.hpp"
+
+#if FF_SIMD_X86
+#include <immintrin.h>
+#endif
+
+// --- Epicycle Chain Kernels ---
+// Structure-of-arrays kernels over phasor re/im arrays:
+//   Rotate: ph[i] *= rot[i]                      (advance one time step)
+//   Sum:    sum of ph[0..n)                      (pen tip)
+//   Prefix: out[i] = ph[0] + ... + ph[i]         (every joint of the chain)
+// All arrays must be Simd::ALIGNMENT-aligned. The ISA is picked per call
+// from Simd::Active(); tails shorter than one register run scalar.
+class ChainKernels {
+public:
+    static void Rotate(double* phRe, double* phIm, const double* rotRe, const double* rotIm, size_t n) {
+#if FF_SIMD_X86
+        switch (Simd::Active()) {
+            case Simd::Level::AVX512: RotateAVX512(phRe, phIm, rotRe, rotIm, n); return;
+            case Simd::Level::AVX2: RotateAVX2(phRe, phIm, rotRe, rotIm, n); return;
+            default: RotateSSE2(phRe, phIm, rotRe, rotIm, n); return;
+        }
+#else
+        RotateScalar(phRe, phIm, rotRe, rotIm, 0, n);
+#endif
+    }
+
+    static std::complex<double> Sum(const double* re, const double* im, size_t n) {
+#if FF_SIMD_X86
+        switch (Simd::Active()) {
+            case Simd::Level::AVX512: return SumAVX512(re, im, n);
+            case Simd::Level::AVX2: return SumAVX2(re, im, n);
+            default: return SumSSE2(re, im, n);
+        }
+#else
+        return SumScalar(re, im, 0, n, std::complex<double>(0, 0));
+#endif
+    }
+
+    static void Prefix(const double* re, const double* im, double* outRe, double* outIm, size_t n) {
+#if FF_SIMD_X86
+        switch (Simd::Active()) {
+            case Simd::Level::AVX512: PrefixAVX512(re, im, outRe, outIm, n); return;
+            case Simd::Level::AVX2: PrefixAVX2(re, im, outRe, outIm, n); return;
+            default: PrefixSSE2(re, im, outRe, outIm, n); return;
+        }
+#else
+        PrefixScalar(re, im, outRe, outIm, 0, n, 0.0, 0.0);
+#endif
+    }
+
+private:
+    // --- Scalar tails ---
+    static void RotateScalar(double* phRe, double* phIm, const double* rotRe, const double* rotIm,
+                             size_t i, size_t n) {
+        for (; i < n; ++i) {
+            double r = phRe[i] * rotRe[i] - phIm[i] * rotIm[i];
+            double m = phRe[i] * rotIm[i] + phIm[i] * rotRe[i];
+            phRe[i] = r;
+            phIm[i] = m;
+        }
+    }
+
+    static std::complex<double> SumScalar(const double* re, const double* im, size_t i, size_t n,
+                                          std::complex<double> acc) {
+        double sr = acc.real(), si = acc.imag();
+        for (; i < n; ++i) { sr += re[i]; si += im[i]; }
+        return std::complex<double>(sr, si);
+    }
+
+    static void PrefixScalar(const double* re, const double* im, double* outRe, double* outIm,
+                             size_t i, size_t n, double cr, double ci) {
+        for (; i < n; ++i) {
+            cr += re[i]; ci += im[i];
+            outRe[i] = cr; outIm[i] = ci;
+        }
+    }
+
+#if FF_SIMD_X86
+    // --- SSE2 (2 lanes) ---
+    static void RotateSSE2(double* phRe, double* phIm, const double* rotRe, const double* rotIm, size_t n) {
+        size_t i = 0;
+        for (; i + 2 <= n; i += 2) {
+            __m128d pr = _mm_load_pd(phRe + i), pi = _mm_load_pd(phIm + i);
+            __m128d rr = _mm_load_pd(rotRe + i), ri = _mm_load_pd(rotIm + i);
+            _mm_store_pd(phRe + i, _mm_sub_pd(_mm_mul_pd(pr, rr), _mm_mul_pd(pi, ri)));
+            _mm_store_pd(phIm + i, _mm_add_pd(_mm_mul_pd(pr, ri), _mm_mul_pd(pi, rr)));
+        }
+        RotateScalar(phRe, phIm, rotRe, rotIm, i, n);
+    }
+
+    static std::complex<double> SumSSE2(const double* re, const double* im, size_t n) {
+        __m128d ar = _mm_setzero_pd(), ai = _mm_setzero_pd();
+        size_t i = 0;
+        for (; i + 2 <= n; i += 2) {
+            ar = _mm_add_pd(ar, _mm_load_pd(re + i));
+            ai = _mm_add_pd(ai, _mm_load_pd(im + i));
+        }
+        double r[2], m[2];
+        _mm_storeu_pd(r, ar); _mm_storeu_pd(m, ai);
+        return SumScalar(re, im, i, n, std::complex<double>(r[0] + r[1], m[0] + m[1]));
+    }
+
+    static inline __m128d ScanSSE2(__m128d x, __m128d carry) {
+        x = _mm_add_pd(x, _mm_unpacklo_pd(_mm_setzero_pd(), x));   // [a0, a0+a1]
+        return _mm_add_pd(x, carry);
+    }
+
+    static void PrefixSSE2(const double* re, const double* im, double* outRe, double* outIm, size_t n) {
+        __m128d cr = _mm_setzero_pd(), ci = _mm_setzero_pd();
+        size_t i = 0;
+        for (; i + 2 <= n; i += 2) {
+            __m128d xr = ScanSSE2(_mm_load_pd(re + i), cr);
+            __m128d xi = ScanSSE2(_mm_load_pd(im + i), ci);
+            _mm_store_pd(outRe + i, xr);
+            _mm_store_pd(outIm + i, xi);
+            cr = _mm_unpackhi_pd(xr, xr);
+            ci = _mm_unpackhi_pd(xi, xi);
+        }
+        PrefixScalar(re, im, outRe, outIm, i, n, _mm_cvtsd_f64(cr), _mm_cvtsd_f64(ci));
+    }
+
+    // --- AVX2 (4 lanes) ---
+    FF_TARGET_AVX2 static void RotateAVX2(double* phRe, double* phIm, const double* rotRe, const double* rotIm, size_t n) {
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            __m256d pr = _mm256_load_pd(phRe + i), pi = _mm256_load_pd(phIm + i);
+            __m256d rr = _mm256_load_pd(rotRe + i), ri = _mm256_load_pd(rotIm + i);
+            _mm256_store_pd(phRe + i, _mm256_fmsub_pd(pr, rr, _mm256_mul_pd(pi, ri)));
+            _mm256_store_pd(phIm + i, _mm256_fmadd_pd(pr, ri, _mm256_mul_pd(pi, rr)));
+        }
+        RotateScalar(phRe, phIm, rotRe, rotIm, i, n);
+    }
+
+    FF_TARGET_AVX2 static std::complex<double> SumAVX2(const double* re, const double* im, size_t n) {
+        __m256d ar = _mm256_setzero_pd(), ai = _mm256_setzero_pd();
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            ar = _mm256_add_pd(ar, _mm256_load_pd(re + i));
+            ai = _mm256_add_pd(ai, _mm256_load_pd(im + i));
+        }
+        double r[4], m[4];
+        _mm256_storeu_pd(r, ar); _mm256_storeu_pd(m, ai);
+        return SumScalar(re, im, i, n, std::complex<double>((r[0] + r[1]) + (r[2] + r[3]),
+                                                            (m[0] + m[1]) + (m[2] + m[3])));
+    }
+
+    FF_TARGET_AVX2 static inline __m256d ScanAVX2(__m256d x, __m256d carry) {
+        const __m256d zero = _mm256_setzero_pd();
+        // shift up one lane, then two lanes (Hillis-Steele in-register scan)
+        x = _mm256_add_pd(x, _mm256_blend_pd(_mm256_permute4x64_pd(x, _MM_SHUFFLE(2, 1, 0, 0)), zero, 0x1));
+        x = _mm256_add_pd(x, _mm256_permute2f128_pd(x, x, 0x08));
+        return _mm256_add_pd(x, carry);
+    }
+
+    FF_TARGET_AVX2 static void PrefixAVX2(const double* re, const double* im, double* outRe, double* outIm, size_t n) {
+        __m256d cr = _mm256_setzero_pd(), ci = _mm256_setzero_pd();
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            __m256d xr = ScanAVX2(_mm256_load_pd(re + i), cr);
+            __m256d xi = ScanAVX2(_mm256_load_pd(im + i), ci);
+            _mm256_store_pd(outRe + i, xr);
+            _mm256_store_pd(outIm + i, xi);
+            cr = _mm256_permute4x64_pd(xr, _MM_SHUFFLE(3, 3, 3, 3));
+            ci = _mm256_permute4x64_pd(xi, _MM_SHUFFLE(3, 3, 3, 3));
+        }
+        PrefixScalar(re, im, outRe, outIm, i, n, _mm256_cvtsd_f64(cr), _mm256_cvtsd_f64(ci));
+    }
+
+    // --- AVX-512 (8 lanes) ---
+    FF_TARGET_AVX512 static void RotateAVX512(double* phRe, double* phIm, const double* rotRe, const double* rotIm, size_t n) {
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m512d pr = _mm512_load_pd(phRe + i), pi = _mm512_load_pd(phIm + i);
+            __m512d rr = _mm512_load_pd(rotRe + i), ri = _mm512_load_pd(rotIm + i);
+            _mm512_store_pd(phRe + i, _mm512_fmsub_pd(pr, rr, _mm512_mul_pd(pi, ri)));
+            _mm512_store_pd(phIm + i, _mm512_fmadd_pd(pr, ri, _mm512_mul_pd(pi, rr)));
+        }
+        RotateScalar(phRe, phIm, rotRe, rotIm, i, n);
+    }
+
+    FF_TARGET_AVX512 static std::complex<double> SumAVX512(const double* re, const double* im, size_t n) {
+        __m512d ar = _mm512_setzero_pd(), ai = _mm512_setzero_pd();
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            ar = _mm512_add_pd(ar, _mm512_load_pd(re + i));
+            ai = _mm512_add_pd(ai, _mm512_load_pd(im + i));
+        }
+        double r[8], m[8];
+        _mm512_storeu_pd(r, ar); _mm512_storeu_pd(m, ai);
+        double sr = ((r[0] + r[1]) + (r[2] + r[3])) + ((r[4] + r[5]) + (r[6] + r[7]));
+        double si = ((m[0] + m[1]) + (m[2] + m[3])) + ((m[4] + m[5]) + (m[6] + m[7]));
+        return SumScalar(re, im, i, n, std::complex<double>(sr, si));
+    }
+
+    FF_TARGET_AVX512 static inline __m512d ScanAVX512(__m512d x, __m512d carry) {
+        const __m512i shift1 = _mm512_set_epi64(6, 5, 4, 3, 2, 1, 0, 0);
+        const __m512i shift2 = _mm512_set_epi64(5, 4, 3, 2, 1, 0, 0, 0);
+        const __m512i shift4 = _mm512_set_epi64(3, 2, 1, 0, 0, 0, 0, 0);
+        x = _mm512_add_pd(x, _mm512_maskz_permutexvar_pd(0xFE, shift1, x));
+        x = _mm512_add_pd(x, _mm512_maskz_permutexvar_pd(0xFC, shift2, x));
+        x = _mm512_add_pd(x, _mm512_maskz_permutexvar_pd(0xF0, shift4, x));
+        return _mm512_add_pd(x, carry);
+    }
+
+    FF_TARGET_AVX512 static void PrefixAVX512(const double* re, const double* im, double* outRe, double* outIm, size_t n) {
+        __m512d cr = _mm512_setzero_pd(), ci = _mm512_setzero_pd();
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m512d xr = ScanAVX512(_mm512_load_pd(re + i), cr);
+            __m512d xi = ScanAVX512(_mm512_load_pd(im + i), ci);
+            _mm512_store_pd(outRe + i, xr);
+            _mm512_store_pd(outIm + i, xi);
+            cr = _mm512_set1_pd(outRe[i + 7]);
+            ci = _mm512_set1_pd(outIm[i + 7]);
+        }
+        PrefixScalar(re, im, outRe, outIm, i, n, i ? outRe[i - 1] : 0.0, i ? outIm[i - 1] : 0.0);
+    }
+#endif
+};
@@ -0,0 +1,601 @@
+#pragma once
+#include <vector>
+#include <complex>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <cmath>
+#include <cstdint>
+
+#include "Parallel.hpp"
+#include "Simd.hpp"
+
+// --- FFT Plan ---
+// Forward transform: X[k] = sum_n x[n] * e^(-2*pi*i*k*n/N)  (unnormalized)
+//
+// Smooth sizes (all prime factors <= MAX_DIRECT_RADIX) run a recursive
+// mixed-radix Cooley-Tukey with dedicated radix-4/2/3/5 butterflies.
+// Anything else (primes, 2 * large prime, ...) goes through Bluestein's
+// chirp-z, which re-expresses the DFT as a power-of-two convolution.
+class FFTPlan {
+public:
+    using cpx = std::complex<double>;
+
+    // Largest prime factor handled by Cooley-Tukey; above it, Bluestein.
+    static constexpr size_t MAX_DIRECT_RADIX = 64;
+
+    // Shared, immutable plan for size n. Plans (twiddles, factorization,
+    // Bluestein chirps) are built once and reused for every later request.
+    static std::shared_ptr<const FFTPlan> Get(size_t n) {
+        static std::mutex cacheMutex;
+        static std::unordered_map<size_t, std::shared_ptr<const FFTPlan>> cache;
+
+        {
+            std::lock_guard<std::mutex> lock(cacheMutex);
+            auto it = cache.find(n);
+            if (it != cache.end()) return it->second;
+        }
+
+        // Built outside the lock: Bluestein plans request their inner plan.
+        std::shared_ptr<const FFTPlan> plan(new FFTPlan(n));
+
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        return cache.emplace(n, plan).first->second;
+    }
+
+    size_t Size() const { return n; }
+    bool UsesBluestein() const { return bluestein; }
+
+    // out must not alias in. Both hold Size() elements.
+    // threads > 1 splits sub-transforms and butterflies across workers;
+    // the result is bit-identical to the single-threaded transform.
+    void Forward(const cpx* in, cpx* out, unsigned threads = 1) const {
+        if (n == 0) return;
+        if (n < PARALLEL_MIN_SIZE) threads = 1;
+        if (bluestein) BluesteinTransform(in, out, threads);
+        else if (threads > 1) ParallelWork(out, in, threads);
+        else Work(out, in, 1, factors.data());
+    }
+
+    // Unnormalized inverse (caller divides by N if needed).
+    void Inverse(const cpx* in, cpx* out, unsigned threads = 1) const {
+        std::vector<cpx> tmp(in, in + n);
+        for (auto& c : tmp) c = std::conj(c);
+        Forward(tmp.data(), out, threads);
+        for (size_t i = 0; i < n; ++i) out[i] = std::conj(out[i]);
+    }
+
+    std::vector<cpx> Forward(const std::vector<cpx>& in) const {
+        std::vector<cpx> out(n);
+        Forward(in.data(), out.data());
+        return out;
+    }
+
+    // --- Batched Transform ---
+    // Transforms `lanes` independent signals at once. Sample n of signal b
+    // lives at re[n * lanes + b] / im[n * lanes + b], so one SIMD register
+    // holds the same sample of several signals and every butterfly runs
+    // across signals. lanes must be a multiple of Simd::MAX_LANES and all
+    // four arrays Simd::ALIGNMENT-aligned. out must not alias in.
+    void ForwardBatch(const double* inRe, const double* inIm, double* outRe, double* outIm, size_t lanes) const {
+        if (n == 0 || lanes == 0) return;
+#if FF_SIMD_X86
+        switch (Simd::Active()) {
+            case Simd::Level::AVX512: BatchAVX512(inRe, inIm, outRe, outIm, lanes); return;
+            case Simd::Level::AVX2: BatchAVX2(inRe, inIm, outRe, outIm, lanes); return;
+            default: break;
+        }
+#endif
+        BatchKernel<2>(*this, inRe, inIm, outRe, outIm, lanes);
+    }
+
+private:
+    static constexpr size_t PARALLEL_MIN_SIZE = 4096;  // below this, threads cost more than they save
+    static constexpr size_t PARALLEL_GRAIN = 8192;     // min butterfly elements per chunk
+
+    size_t n;
+    bool bluestein = false;
+    std::vector<size_t> factors;     // pairs (radix p, remaining length m)
+    std::vector<cpx> twiddles;       // e^(-2*pi*i*k/N), k < N
+    std::vector<uint32_t> leafOrder; // input index feeding each output slot before the butterflies
+
+    // Bluestein state
+    std::shared_ptr<const FFTPlan> inner;  // power-of-two plan, size >= 2N-1
+    std::vector<cpx> chirp;                // e^(-i*pi*k^2/N), k < N
+    std::vector<cpx> chirpSpectrum;        // FFT of conj chirp filter, pre-scaled by 1/M
+
+    explicit FFTPlan(size_t size) : n(size) {
+        if (n <= 1) {
+            factors = {1, 1};
+            return;
+        }
+
+        // Radix 4 first (fewest passes), then 2, then odd primes ascending.
+        size_t rem = n;
+        size_t p = 4;
+        bool smooth = true;
+        while (rem > 1) {
+            while (rem % p != 0) {
+                if (p == 4) p = 2;
+                else if (p == 2) p = 3;
+                else p += 2;
+                if (p * p > rem) p = rem;
+            }
+            if (p > MAX_DIRECT_RADIX) { smooth = false; break; }
+            rem /= p;
+            factors.push_back(p);
+            factors.push_back(rem);
+        }
+
+        if (!smooth) {
+            factors.clear();
+            SetupBluestein();
+            return;
+        }
+
+        twiddles.resize(n);
+        for (size_t k = 0; k < n; ++k) {
+            double phi = -2.0 * M_PI * (double)k / (double)n;
+            twiddles[k] = cpx(std::cos(phi), std::sin(phi));
+        }
+
+        leafOrder.resize(n);
+        FillLeafOrder(0, 0, 1, factors.data());
+    }
+
+    // Mirrors the leaf copies of Work() so the batched path can run the
+    // same decomposition iteratively.
+    void FillLeafOrder(size_t outPos, size_t inPos, size_t stride, const size_t* fac) {
+        const size_t p = fac[0];
+        const size_t m = fac[1];
+        for (size_t j = 0; j < p; ++j) {
+            if (m == 1) leafOrder[outPos + j] = (uint32_t)(inPos + j * stride);
+            else FillLeafOrder(outPos + j * m, inPos + j * stride, stride * p, fac + 2);
+        }
+    }
+
+    void SetupBluestein() {
+        bluestein = true;
+
+        size_t m = 1;
+        while (m < 2 * n - 1) m <<= 1;
+        inner = Get(m);
+
+        // k^2 mod 2N keeps the chirp argument small and exact for large N.
+        chirp.resize(n);
+        for (size_t k = 0; k < n; ++k) {
+            uint64_t k2 = ((uint64_t)k * (uint64_t)k) % (2 * (uint64_t)n);
+            double phi = -M_PI * (double)k2 / (double)n;
+            chirp[k] = cpx(std::cos(phi), std::sin(phi));
+        }
+
+        std::vector<cpx> filter(m, cpx(0, 0));
+        filter[0] = std::conj(chirp[0]);
+        for (size_t k = 1; k < n; ++k) {
+            filter[k] = std::conj(chirp[k]);
+            filter[m - k] = std::conj(chirp[k]);
+        }
+        chirpSpectrum = inner->Forward(filter);
+        double scale = 1.0 / (double)m;
+        for (auto& c : chirpSpectrum) c *= scale;
+    }
+
+    void BluesteinTransform(const cpx* in, cpx* out, unsigned threads) const {
+        size_t m = inner->Size();
+        std::vector<cpx> a(m, cpx(0, 0));
+        std::vector<cpx> spec(m);
+
+        Parallel::For(0, n, threads, PARALLEL_GRAIN, [&](size_t lo, size_t hi) {
+            for (size_t k = lo; k < hi; ++k) a[k] = in[k] * chirp[k];
+        });
+        inner->Forward(a.data(), spec.data(), threads);
+
+        // Circular convolution: IFFT(A .* B) via the conjugation trick.
+        Parallel::For(0, m, threads, PARALLEL_GRAIN, [&](size_t lo, size_t hi) {
+            for (size_t k = lo; k < hi; ++k) spec[k] = std::conj(spec[k] * chirpSpectrum[k]);
+        });
+        inner->Forward(spec.data(), a.data(), threads);
+
+        Parallel::For(0, n, threads, PARALLEL_GRAIN, [&](size_t lo, size_t hi) {
+            for (size_t k = lo; k < hi; ++k) out[k] = std::conj(a[k]) * chirp[k];
+        });
+    }
+
+    // --- Recursive decimation in time ---
+    // Writes the DFT of in[0], in[stride], ... (length p*m) to out[0..p*m).
+    void Work(cpx* out, const cpx* in, size_t stride, const size_t* fac) const {
+        const size_t p = fac[0];
+        const size_t m = fac[1];
+        cpx* const begin = out;
+        cpx* const end = out + p * m;
+
+        if (m == 1) {
+            for (; out != end; ++out, in += stride) *out = *in;
+        } else {
+            for (; out != end; out += m, in += stride) {
+                Work(out, in, stride * p, fac + 2);
+            }
+        }
+
+        Butterfly(begin, stride, p, m, 0, m);
+    }
+
+    // Radix-p combine of p sub-transforms of length m, columns k0..k1.
+    // Columns are independent, so any split gives bit-identical output.
+    void Butterfly(cpx* f, size_t stride, size_t p, size_t m, size_t k0, size_t k1) const {
+        switch (p) {
+            case 1: break;
+            case 2: Butterfly2(f, stride, m, k0, k1); break;
+            case 3: Butterfly3(f, stride, m, k0, k1); break;
+            case 4: Butterfly4(f, stride, m, k0, k1); break;
+            case 5: Butterfly5(f, stride, m, k0, k1); break;
+            default: ButterflyGeneric(f, stride, m, p, k0, k1); break;
+        }
+    }
+
+    // --- Parallel decimation in time ---
+    // Same recursion as Work(), unrolled for the top `depth` levels: the
+    // independent sub-transforms at that depth are spread across threads,
+    // then each level's butterflies are split by column.
+    void ParallelWork(cpx* out, const cpx* in, unsigned threads) const {
+        const size_t levels = factors.size() / 2;
+
+        size_t depth = 0, units = 1;
+        while (depth + 1 < levels && units < 4 * (size_t)threads) {
+            units *= factors[2 * depth];
+            ++depth;
+        }
+
+        // Sub-transform u covers out[u*len .. (u+1)*len) and reads the input
+        // at offset sum(j_l * s_l) with stride s_depth (s_l = p_0*...*p_{l-1}).
+        const size_t len = factors[2 * depth] * factors[2 * depth + 1];
+        Parallel::For(0, units, threads, 1, [&](size_t lo, size_t hi) {
+            for (size_t u = lo; u < hi; ++u) {
+                size_t rem = u, offset = 0, s = 1;
+                for (size_t l = 0; l < depth; ++l) {
+                    size_t block = factors[2 * l + 1] / len;  // m_l / len
+                    offset += (rem / block) * s;
+                    rem %= block;
+                    s *= factors[2 * l];
+                }
+                Work(out + u * len, in + offset, units, factors.data() + 2 * depth);
+            }
+        });
+
+        for (size_t l = depth; l-- > 0;) {
+            const size_t p = factors[2 * l];
+            const size_t m = factors[2 * l + 1];
+            size_t stride = 1;
+            for (size_t i = 0; i < l; ++i) stride *= factors[2 * i];
+            const size_t groups = n / (p * m);
+
+            Parallel::For(0, groups * m, threads, PARALLEL_GRAIN / p, [&](size_t lo, size_t hi) {
+                while (lo < hi) {
+                    size_t g = lo / m;
+                    size_t k0 = lo % m;
+                    size_t k1 = std::min(m, k0 + (hi - lo));
+                    Butterfly(out + g * p * m, stride, p, m, k0, k1);
+                    lo += k1 - k0;
+                }
+            });
+        }
+    }
+
+    void Butterfly2(cpx* f, size_t stride, size_t m, size_t k0, size_t k1) const {
+        for (size_t k = k0; k < k1; ++k) {
+            cpx t = f[k + m] * twiddles[k * stride];
+            f[k + m] = f[k] - t;
+            f[k] += t;
+        }
+    }
+
+    void Butterfly3(cpx* f, size_t stride, size_t m, size_t k0, size_t k1) const {
+        const double epi3 = twiddles[stride * m].imag();  // -sin(2pi/3)
+        for (size_t k = k0; k < k1; ++k) {
+            cpx s1 = f[k + m] * twiddles[k * stride];
+            cpx s2 = f[k + 2 * m] * twiddles[2 * k * stride];
+            cpx s3 = s1 + s2;
+            cpx s0 = s1 - s2;
+
+            cpx a = f[k] - s3 * 0.5;
+            s0 *= epi3;
+            f[k] += s3;
+            f[k + 2 * m] = cpx(a.real() + s0.imag(), a.imag() - s0.real());
+            f[k + m] = cpx(a.real() - s0.imag(), a.imag() + s0.real());
+        }
+    }
+
+    void Butterfly4(cpx* f, size_t stride, size_t m, size_t k0, size_t k1) const {
+        for (size_t k = k0; k < k1; ++k) {
+            cpx s0 = f[k + m] * twiddles[k * stride];
+            cpx s1 = f[k + 2 * m] * twiddles[2 * k * stride];
+            cpx s2 = f[k + 3 * m] * twiddles[3 * k * stride];
+
+            cpx s5 = f[k] - s1;
+            f[k] += s1;
+            cpx s3 = s0 + s2;
+            cpx s4 = s0 - s2;
+            f[k + 2 * m] = f[k] - s3;
+            f[k] += s3;
+            // Multiply by -i for the forward direction
+            f[k + m] = cpx(s5.real() + s4.imag(), s5.imag() - s4.real());
+            f[k + 3 * m] = cpx(s5.real() - s4.imag(), s5.imag() + s4.real());
+        }
+    }
+
+    void Butterfly5(cpx* f, size_t stride, size_t m, size_t k0, size_t k1) const {
+        const cpx ya = twiddles[stride * m];
+        const cpx yb = twiddles[2 * stride * m];
+        for (size_t k = k0; k < k1; ++k) {
+            cpx s0 = f[k];
+            cpx s1 = f[k + m] * twiddles[k * stride];
+            cpx s2 = f[k + 2 * m] * twiddles[2 * k * stride];
+            cpx s3 = f[k + 3 * m] * twiddles[3 * k * stride];
+            cpx s4 = f[k + 4 * m] * twiddles[4 * k * stride];
+
+            cpx s7 = s1 + s4, s10 = s1 - s4;
+            cpx s8 = s2 + s3, s9 = s2 - s3;
+
+            f[k] = s0 + s7 + s8;
+
+            cpx s5(s0.real() + s7.real() * ya.real() + s8.real() * yb.real(),
+                   s0.imag() + s7.imag() * ya.real() + s8.imag() * yb.real());
+            cpx s6(s10.imag() * ya.imag() + s9.imag() * yb.imag(),
+                   -s10.real() * ya.imag() - s9.real() * yb.imag());
+            f[k + m] = s5 - s6;
+            f[k + 4 * m] = s5 + s6;
+
+            cpx s11(s0.real() + s7.real() * yb.real() + s8.real() * ya.real(),
+                    s0.imag() + s7.imag() * yb.real() + s8.imag() * ya.real());
+            cpx s12(-s10.imag() * yb.imag() + s9.imag() * ya.imag(),
+                    s10.real() * yb.imag() - s9.real() * ya.imag());
+            f[k + 2 * m] = s11 + s12;
+            f[k + 3 * m] = s11 - s12;
+        }
+    }
+
+    void ButterflyGeneric(cpx* f, size_t stride, size_t m, size_t p, size_t k0, size_t k1) const {
+        std::vector<cpx> scratch(p);
+        for (size_t u = k0; u < k1; ++u) {
+            for (size_t q = 0, k = u; q < p; ++q, k += m) scratch[q] = f[k];
+
+            for (size_t q = 0, k = u; q < p; ++q, k += m) {
+                size_t twIdx = 0;
+                f[k] = scratch[0];
+                for (size_t j = 1; j < p; ++j) {
+                    twIdx += stride * k;
+                    if (twIdx >= n) twIdx -= n;
+                    f[k] += scratch[j] * twiddles[twIdx];
+                }
+            }
+        }
+    }
+
+    // --- Batched Kernels ---
+#if FF_SIMD_X86
+    FF_TARGET_AVX512 void BatchAVX512(const double* inRe, const double* inIm, double* outRe, double* outIm, size_t lanes) const {
+        BatchKernel<8>(*this, inRe, inIm, outRe, outIm, lanes);
+    }
+    FF_TARGET_AVX2 void BatchAVX2(const double* inRe, const double* inIm, double* outRe, double* outIm, size_t lanes) const {
+        BatchKernel<4>(*this, inRe, inIm, outRe, outIm, lanes);
+    }
+#endif
+
+    template<int W>
+    static FF_ALWAYS_INLINE void BatchKernel(const FFTPlan& plan, const double* inRe, const double* inIm,
+                                             double* outRe, double* outIm, size_t lanes) {
+        if (plan.bluestein) BatchBluestein<W>(plan, inRe, inIm, outRe, outIm, lanes);
+        else BatchDirect<W>(plan, inRe, inIm, outRe, outIm, lanes);
+    }
+
+    // Iterative form of Work(): leaf permutation, then butterflies level by
+    // level from the innermost radix outwards.
+    template<int W>
+    static FF_ALWAYS_INLINE void BatchDirect(const FFTPlan& plan, const double* inRe, const double* inIm,
+                                             double* outRe, double* outIm, size_t lanes) {
+        typedef typename Simd::VecD<W>::type V;
+        const size_t n = plan.n;
+
+        for (size_t pos = 0; pos < n; ++pos) {
+            const size_t src = plan.leafOrder.empty() ? pos : plan.leafOrder[pos];
+            for (size_t b = 0; b < lanes; b += W) {
+                *(V*)(outRe + pos * lanes + b) = *(const V*)(inRe + src * lanes + b);
+                *(V*)(outIm + pos * lanes + b) = *(const V*)(inIm + src * lanes + b);
+            }
+        }
+
+        const size_t levels = plan.factors.size() / 2;
+        for (size_t l = levels; l-- > 0;) {
+            const size_t p = plan.factors[2 * l];
+            const size_t m = plan.factors[2 * l + 1];
+            size_t stride = 1;
+            for (size_t i = 0; i < l; ++i) stride *= plan.factors[2 * i];
+
+            for (size_t base = 0; base < n; base += p * m) {
+                for (size_t k = 0; k < m; ++k) {
+                    switch (p) {
+                        case 1: break;
+                        case 2: BatchButterfly2<W>(plan, outRe, outIm, base, k, m, stride, lanes); break;
+                        case 3: BatchButterfly3<W>(plan, outRe, outIm, base, k, m, stride, lanes); break;
+                        case 4: BatchButterfly4<W>(plan, outRe, outIm, base, k, m, stride, lanes); break;
+                        case 5: BatchButterfly5<W>(plan, outRe, outIm, base, k, m, stride, lanes); break;
+                        default: BatchButterflyGeneric<W>(plan, outRe, outIm, base, k, m, p, stride, lanes); break;
+                    }
+                }
+            }
+        }
+    }
+
+    template<int W>
+    static FF_ALWAYS_INLINE void BatchBluestein(const FFTPlan& plan, const double* inRe, const double* inIm,
+                                                double* outRe, double* outIm, size_t lanes) {
+        typedef typename Simd::VecD<W>::type V;
+        const FFTPlan& in = *plan.inner;
+        const size_t n = plan.n;
+        const size_t m = in.n;
+
+        Simd::AlignedVector<double> aRe(m * lanes, 0.0), aIm(m * lanes, 0.0);
+        Simd::AlignedVector<double> sRe(m * lanes), sIm(m * lanes);
+
+        for (size_t k = 0; k < n; ++k) {
+            const double cr = plan.chirp[k].real(), ci = plan.chirp[k].imag();
+            for (size_t b = 0; b < lanes; b += W) {
+                V xr = *(const V*)(inRe + k * lanes + b), xi = *(const V*)(inIm + k * lanes + b);
+                *(V*)(&aRe[k * lanes + b]) = xr * cr - xi * ci;
+                *(V*)(&aIm[k * lanes + b]) = xr * ci + xi * cr;
+            }
+        }
+        BatchDirect<W>(in, aRe.data(), aIm.data(), sRe.data(), sIm.data(), lanes);
+
+        // conj(S .* B), then forward again = conj of the circular convolution
+        for (size_t k = 0; k < m; ++k) {
+            const double br = plan.chirpSpectrum[k].real(), bi = plan.chirpSpectrum[k].imag();
+            for (size_t b = 0; b < lanes; b += W) {
+                V xr = *(V*)(&sRe[k * lanes + b]), xi = *(V*)(&sIm[k * lanes + b]);
+                *(V*)(&sRe[k * lanes + b]) = xr * br - xi * bi;
+                *(V*)(&sIm[k * lanes + b]) = -(xr * bi + xi * br);
+            }
+        }
+        BatchDirect<W>(in, sRe.data(), sIm.data(), aRe.data(), aIm.data(), lanes);
+
+        for (size_t k = 0; k < n; ++k) {
+            const double cr = plan.chirp[k].real(), ci = plan.chirp[k].imag();
+            for (size_t b = 0; b < lanes; b += W) {
+                V xr = *(V*)(&aRe[k * lanes + b]), xi = -*(V*)(&aIm[k * lanes + b]);
+                *(V*)(outRe + k * lanes + b) = xr * cr - xi * ci;
+                *(V*)(outIm + k * lanes + b) = xr * ci + xi * cr;
+            }
+        }
+    }
+
+    template<int W>
+    static FF_ALWAYS_INLINE void BatchButterfly2(const FFTPlan& plan, double* re, double* im, size_t base,
+                                                 size_t k, size_t m, size_t stride, size_t lanes) {
+        typedef typename Simd::VecD<W>::type V;
+        const double wr = plan.twiddles[k * stride].real(), wi = plan.twiddles[k * stride].imag();
+        double* r0 = re + (base + k) * lanes; double* i0 = im + (base + k) * lanes;
+        double* r1 = r0 + m * lanes;          double* i1 = i0 + m * lanes;
+        for (size_t b = 0; b < lanes; b += W) {
+            V ar = *(V*)(r0 + b), ai = *(V*)(i0 + b);
+            V xr = *(V*)(r1 + b), xi = *(V*)(i1 + b);
+            V tr = xr * wr - xi * wi, ti = xr * wi + xi * wr;
+            *(V*)(r1 + b) = ar - tr; *(V*)(i1 + b) = ai - ti;
+            *(V*)(r0 + b) = ar + tr; *(V*)(i0 + b) = ai + ti;
+        }
+    }
+
+    template<int W>
+    static FF_ALWAYS_INLINE void BatchButterfly3(const FFTPlan& plan, double* re, double* im, size_t base,
+                                                 size_t k, size_t m, size_t stride, size_t lanes) {
+        typedef typename Simd::VecD<W>::type V;
+        const double epi3 = plan.twiddles[stride * m].imag();
+        const cpx w1 = plan.twiddles[k * stride], w2 = plan.twiddles[2 * k * stride];
+        double* r0 = re + (base + k) * lanes; double* i0 = im + (base + k) * lanes;
+        const size_t step = m * lanes;
+        for (size_t b = 0; b < lanes; b += W) {
+            V fr = *(V*)(r0 + b), fi = *(V*)(i0 + b);
+            V xr = *(V*)(r0 + step + b), xi = *(V*)(i0 + step + b);
+            V yr = *(V*)(r0 + 2 * step + b), yi = *(V*)(i0 + 2 * step + b);
+            V s1r = xr * w1.real() - xi * w1.imag(), s1i = xr * w1.imag() + xi * w1.real();
+            V s2r = yr * w2.real() - yi * w2.imag(), s2i = yr * w2.imag() + yi * w2.real();
+            V s3r = s1r + s2r, s3i = s1i + s2i;
+            V s0r = (s1r - s2r) * epi3, s0i = (s1i - s2i) * epi3;
+            V ar = fr - s3r * 0.5, ai = fi - s3i * 0.5;
+            *(V*)(r0 + b) = fr + s3r; *(V*)(i0 + b) = fi + s3i;
+            *(V*)(r0 + 2 * step + b) = ar + s0i; *(V*)(i0 + 2 * step + b) = ai - s0r;
+            *(V*)(r0 + step + b) = ar - s0i;     *(V*)(i0 + step + b) = ai + s0r;
+        }
+    }
+
+    template<int W>
+    static FF_ALWAYS_INLINE void BatchButterfly4(const FFTPlan& plan, double* re, double* im, size_t base,
+                                                 size_t k, size_t m, size_t stride, size_t lanes) {
+        typedef typename Simd::VecD<W>::type V;
+        const cpx w1 = plan.twiddles[k * stride], w2 = plan.twiddles[2 * k * stride], w3 = plan.twiddles[3 * k * stride];
+        double* r0 = re + (base + k) * lanes; double* i0 = im + (base + k) * lanes;
+        const size_t step = m * lanes;
+        for (size_t b = 0; b < lanes; b += W) {
+            V fr = *(V*)(r0 + b), fi = *(V*)(i0 + b);
+            V xr = *(V*)(r0 + step + b), xi = *(V*)(i0 + step + b);
+            V yr = *(V*)(r0 + 2 * step + b), yi = *(V*)(i0 + 2 * step + b);
+            V zr = *(V*)(r0 + 3 * step + b), zi = *(V*)(i0 + 3 * step + b);
+            V s0r = xr * w1.real() - xi * w1.imag(), s0i = xr * w1.imag() + xi * w1.real();
+            V s1r = yr * w2.real() - yi * w2.imag(), s1i = yr * w2.imag() + yi * w2.real();
+            V s2r = zr * w3.real() - zi * w3.imag(), s2i = zr * w3.imag() + zi * w3.real();
+            V s5r = fr - s1r, s5i = fi - s1i;
+            fr += s1r; fi += s1i;
+            V s3r = s0r + s2r, s3i = s0i + s2i;
+            V s4r = s0r - s2r, s4i = s0i - s2i;
+            *(V*)(r0 + 2 * step + b) = fr - s3r; *(V*)(i0 + 2 * step + b) = fi - s3i;
+            *(V*)(r0 + b) = fr + s3r;            *(V*)(i0 + b) = fi + s3i;
+            *(V*)(r0 + step + b) = s5r + s4i;     *(V*)(i0 + step + b) = s5i - s4r;
+            *(V*)(r0 + 3 * step + b) = s5r - s4i; *(V*)(i0 + 3 * step + b) = s5i + s4r;
+        }
+    }
+
+    template<int W>
+    static FF_ALWAYS_INLINE void BatchButterfly5(const FFTPlan& plan, double* re, double* im, size_t base,
+                                                 size_t k, size_t m, size_t stride, size_t lanes) {
+        typedef typename Simd::VecD<W>::type V;
+        const cpx ya = plan.twiddles[stride * m], yb = plan.twiddles[2 * stride * m];
+        cpx w[5];
+        for (int q = 1; q < 5; ++q) w[q] = plan.twiddles[q * k * stride];
+        double* r0 = re + (base + k) * lanes; double* i0 = im + (base + k) * lanes;
+        const size_t step = m * lanes;
+        for (size_t b = 0; b < lanes; b += W) {
+            V sr[5], si[5];
+            sr[0] = *(V*)(r0 + b); si[0] = *(V*)(i0 + b);
+            for (int q = 1; q < 5; ++q) {
+                V xr = *(V*)(r0 + q * step + b), xi = *(V*)(i0 + q * step + b);
+                sr[q] = xr * w[q].real() - xi * w[q].imag();
+                si[q] = xr * w[q].imag() + xi * w[q].real();
+            }
+            V s7r = sr[1] + sr[4], s7i = si[1] + si[4];
+            V s10r = sr[1] - sr[4], s10i = si[1] - si[4];
+            V s8r = sr[2] + sr[3], s8i = si[2] + si[3];
+            V s9r = sr[2] - sr[3], s9i = si[2] - si[3];
+
+            *(V*)(r0 + b) = sr[0] + s7r + s8r; *(V*)(i0 + b) = si[0] + s7i + s8i;
+
+            V s5r = sr[0] + s7r * ya.real() + s8r * yb.real(), s5i = si[0] + s7i * ya.real() + s8i * yb.real();
+            V s6r = s10i * ya.imag() + s9i * yb.imag(), s6i = -(s10r * ya.imag()) - s9r * yb.imag();
+            *(V*)(r0 + step + b) = s5r - s6r;     *(V*)(i0 + step + b) = s5i - s6i;
+            *(V*)(r0 + 4 * step + b) = s5r + s6r; *(V*)(i0 + 4 * step + b) = s5i + s6i;
+
+            V s11r = sr[0] + s7r * yb.real() + s8r * ya.real(), s11i = si[0] + s7i * yb.real() + s8i * ya.real();
+            V s12r = -(s10i * yb.imag()) + s9i * ya.imag(), s12i = s10r * yb.imag() - s9r * ya.imag();
+            *(V*)(r0 + 2 * step + b) = s11r + s12r; *(V*)(i0 + 2 * step + b) = s11i + s12i;
+            *(V*)(r0 + 3 * step + b) = s11r - s12r; *(V*)(i0 + 3 * step + b) = s11i - s12i;
+        }
+    }
+
+    template<int W>
+    static FF_ALWAYS_INLINE void BatchButterflyGeneric(const FFTPlan& plan, double* re, double* im, size_t base,
+                                                       size_t k, size_t m, size_t p, size_t stride, size_t lanes) {
+        typedef typename Simd::VecD<W>::type V;
+        const size_t n = plan.n;
+        const size_t step = m * lanes;
+        double* r0 = re + (base + k) * lanes; double* i0 = im + (base + k) * lanes;
+        for (size_t b = 0; b < lanes; b += W) {
+            V sr[MAX_DIRECT_RADIX], si[MAX_DIRECT_RADIX];
+            for (size_t q = 0; q < p; ++q) {
+                sr[q] = *(V*)(r0 + q * step + b);
+                si[q] = *(V*)(i0 + q * step + b);
+            }
+            for (size_t q = 0; q < p; ++q) {
+                const size_t kk = k + q * m;
+                size_t twIdx = 0;
+                V accR = sr[0], accI = si[0];
+                for (size_t j = 1; j < p; ++j) {
+                    twIdx += stride * kk;
+                    if (twIdx >= n) twIdx -= n;
+                    const double wr = plan.twiddles[twIdx].real(), wi = plan.twiddles[twIdx].imag();
+                    accR += sr[j] * wr - si[j] * wi;
+                    accI += sr[j] * wi + si[j] * wr;
+                }
+                *(V*)(r0 + q * step + b) = accR;
+                *(V*)(i0 + q * step + b) = accI;
+            }
+        }
+    }
+};
@@ -3,8 +3,16 @@
 #include <complex>
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <glm/glm.hpp>
 
+#include "FFT.hpp"
+#include "BandDFT.hpp"
+#include "Parallel.hpp"
+#include "Simd.hpp"
+#include "ChainKernels.hpp"
+#include "Bezier.hpp"
+
 struct Epicycle {
     std::complex<double> value;
     int frequency;
@@ -18,43 +26,692 @@ struct Epicycle {
     }
 };
 
+// --- Fidelity Target ---
+// How many coefficients a load keeps. By Parseval, dropping a set of
+// epicycles changes the curve by an RMS distance of sqrt(sum |value|^2)
+// over the dropped terms, so the target maps directly onto spectrum energy.
+// Band keeps frequencies -F..F and never computes the others.
+struct Fidelity {
+    enum class Mode { All, RMS, Energy, Band };
+    Mode mode = Mode::All;
+    double value = 0.0;  // RMS: max RMS distance in path units. Energy: fraction to keep, (0, 1]. Band: F.
+
+    static Fidelity All() { return {}; }
+    static Fidelity RMS(double distance) { return {Mode::RMS, distance}; }
+    static Fidelity Energy(double fraction) { return {Mode::Energy, fraction}; }
+    static Fidelity Band(int maxFreq) { return {Mode::Band, (double)maxFreq}; }
+};
+
+// --- SoA Spectrum ---
+// Epicycle coefficients split into aligned arrays so chain kernels can
+// stream them with full-width vector loads. Padding past size() is zero.
+struct SpectrumSoA {
+    Simd::AlignedVector<double> re, im;
+    Simd::AlignedVector<int32_t> freq;
+    size_t size = 0;
+
+    void Assign(const std::vector<Epicycle>& epis) {
+        size = epis.size();
+        const size_t padded = Simd::PadLanes(size);
+        re.assign(padded, 0.0);
+        im.assign(padded, 0.0);
+        freq.assign(padded, 0);
+        for (size_t i = 0; i < size; ++i) {
+            re[i] = epis[i].value.real();
+            im[i] = epis[i].value.imag();
+            freq[i] = epis[i].frequency;
+        }
+    }
+};
+
+// --- Phasor Evaluator ---
+// Tracks value * e^(i * freq * 2pi * t) for every epicycle. Advancing by
+// a fixed dt is one complex multiply per circle by a cached per-step
+// rotation instead of a std::exp; any other jump re-evaluates exactly.
+// Storage is SoA and the per-step work runs through ChainKernels.
+//
+// Circles are amplitude-sorted, so the circles from k onwards can move
+// the tip by at most TailBound(k) = sum of their amplitudes.
+// BoundedCount() uses this to find how many leading circles reproduce
+// the chain within a tolerance. Advance(dt, count) then only steps those.
+// Phasors past `count` go stale and are re-evaluated exactly the next
+// time a Sum or chain needs them.
+class PhasorEvaluator {
+public:
+    void Reset(const std::vector<Epicycle>& epis, double t = 0.0) {
+        spectrum.Assign(epis);
+        const size_t padded = spectrum.re.size();
+        phRe.assign(padded, 0.0);
+        phIm.assign(padded, 0.0);
+        rotRe.clear();
+        rotIm.clear();
+        chainRe.assign(padded, 0.0);
+        chainIm.assign(padded, 0.0);
+        stepDt = 0.0;
+        current = SIZE_MAX;
+
+        // tailAmp[k] = amp[k] + amp[k + 1] + ... (summed from the small end)
+        tailAmp.assign(spectrum.size + 1, 0.0);
+        for (size_t i = spectrum.size; i-- > 0;) tailAmp[i] = tailAmp[i + 1] + std::abs(epis[i].value);
+
+        Seek(t);
+    }
+
+    // Exact evaluation at t (slider seeks, loop wraps, reloads) of the
+    // phasors currently being tracked; stale ones stay stale.
+    void Seek(double t) {
+        time = t;
+        Evaluate(0, current);
+        stepsSinceRenorm = 0;
+    }
+
+    // t += dt by rotation. Rotations are rebuilt only when dt changes.
+    // Only the first `count` phasors are stepped.
+    void Advance(double dt, size_t count = SIZE_MAX) {
+        if (dt == 0.0) return;
+        count = std::min(count, spectrum.size);
+        if (dt != stepDt || rotRe.size() != phRe.size()) {
+            rotRe.assign(phRe.size(), 1.0);
+            rotIm.assign(phRe.size(), 0.0);
+            for (size_t i = 0; i < spectrum.size; ++i) {
+                std::complex<double> r = Rotation(spectrum.freq[i], dt);
+                rotRe[i] = r.real();
+                rotIm[i] = r.imag();
+            }
+            stepDt = dt;
+        }
+
+        Require(count);
+        ChainKernels::Rotate(phRe.data(), phIm.data(), rotRe.data(), rotIm.data(), count);
+        current = count;
+        time += dt;
+
+        if (++stepsSinceRenorm >= RENORM_INTERVAL) Renormalize();
+    }
+
+    // Moves the tracked time to t. Offsets of whole periods and rounding-level
+    // differences (a stepped clock vs. the phasors' own sum) keep the current
+    // state; anything larger re-evaluates exactly.
+    void Follow(double t) {
+        double drift = t - time;
+        drift -= std::round(drift);
+        if (std::abs(drift) > FOLLOW_TOLERANCE) {
+            Seek(t);
+        } else {
+            time = t;
+        }
+    }
+
+    double Time() const { return time; }
+    size_t Size() const { return spectrum.size; }
+    std::complex<double> operator[](size_t i) const { return std::complex<double>(phRe[i], phIm[i]); }
+
+    // Upper bound on how far circles k, k + 1, ... can move the tip.
+    double TailBound(size_t k) const { return tailAmp[std::min(k, spectrum.size)]; }
+
+    // Fewest leading circles (of the first `count`) whose chain stays within
+    // `tolerance` of the full `count`-circle chain.
+    size_t BoundedCount(size_t count, double tolerance) const {
+        count = std::min(count, spectrum.size);
+        const double limit = tailAmp[count] + tolerance;
+        // tailAmp is non-increasing: first k with tailAmp[k] <= limit
+        auto it = std::lower_bound(tailAmp.begin(), tailAmp.begin() + count, limit,
+                                   [](double tail, double lim) { return tail > lim; });
+        return (size_t)(it - tailAmp.begin());
+    }
+
+    // Tip position of the first `count` circles.
+    std::complex<double> Sum(size_t count) {
+        count = std::min(count, spectrum.size);
+        Require(count);
+        return ChainKernels::Sum(phRe.data(), phIm.data(), count);
+    }
+
+    // Tip of the first `count` circles to within `tolerance`, summing only
+    // the circles that can still move it by more than that.
+    std::complex<double> Sum(size_t count, double tolerance) { return Sum(BoundedCount(count, tolerance)); }
+
+    // Joint positions of the first `count` circles: ChainRe()[i] / ChainIm()[i]
+    // is where circle i ends (circle i is centred on joint i - 1, or the origin).
+    void ComputeChain(size_t count) {
+        count = std::min(count, spectrum.size);
+        Require(count);
+        ChainKernels::Prefix(phRe.data(), phIm.data(), chainRe.data(), chainIm.data(), count);
+    }
+    const double* ChainRe() const { return chainRe.data(); }
+    const double* ChainIm() const { return chainIm.data(); }
+
+private:
+    static constexpr int RENORM_INTERVAL = 256;
+    static constexpr double FOLLOW_TOLERANCE = 1e-12;
+
+    SpectrumSoA spectrum;
+    Simd::AlignedVector<double> phRe, phIm;
+    Simd::AlignedVector<double> rotRe, rotIm;
+    Simd::AlignedVector<double> chainRe, chainIm;
+    std::vector<double> tailAmp;
+    size_t current = SIZE_MAX;  // phasors [0, current) are up to date at `time`
+    double stepDt = 0.0;
+    double time = 0.0;
+    int stepsSinceRenorm = 0;
+
+    static std::complex<double> Rotation(int freq, double t) {
+        // Reduce freq * t to [0, 1) turns first so high frequencies keep precision
+        double turns = (double)freq * t;
+        turns -= std::floor(turns);
+        const double angle = 2.0 * M_PI * turns;
+        return std::complex<double>(std::cos(angle), std::sin(angle));
+    }
+
+    void Evaluate(size_t lo, size_t hi) {
+        hi = std::min(hi, spectrum.size);
+        for (size_t i = lo; i < hi; ++i) {
+            std::complex<double> r = Rotation(spectrum.freq[i], time);
+            phRe[i] = spectrum.re[i] * r.real() - spectrum.im[i] * r.imag();
+            phIm[i] = spectrum.re[i] * r.imag() + spectrum.im[i] * r.real();
+        }
+    }
+
+    // Brings stale phasors below `count` up to date.
+    void Require(size_t count) {
+        if (count <= current) return;
+        Evaluate(current, count);
+        current = count;
+    }
+
+    // Rounding in repeated rotations slowly changes each phasor's length;
+    // pull it back to |value| (phase error stays at rounding level).
+    void Renormalize() {
+        const size_t n = std::min(current, spectrum.size);
+        for (size_t i = 0; i < n; ++i) {
+            double len = std::sqrt(phRe[i] * phRe[i] + phIm[i] * phIm[i]);
+            if (len > 0.0) {
+                double scale = std::sqrt(spectrum.re[i] * spectrum.re[i] + spectrum.im[i] * spectrum.im[i]) / len;
+                phRe[i] *= scale;
+                phIm[i] *= scale;
+            }
+        }
+        stepsSinceRenorm = 0;
+    }
+};
+
+// --- Curve Table ---
+// The curve drawn by the first `count` epicycles, sampled at M points over
+// one period by a single inverse FFT (plus a second one for the velocity).
+// Looking up the tip is then O(1) for any t: cubic Hermite interpolation
+// between neighbouring samples using the exact derivatives.
+//
+// Epicycles are amplitude-sorted, so moving the circle count from K to K'
+// only adds or removes the terms in between. SetCount() patches the table
+// at O(M) per term and falls back to a full rebuild when that would be
+// slower, when a new term needs more samples, or after enough patches
+// that rounding could start to build up.
+class CurveTable {
+public:
+    static constexpr size_t MIN_SAMPLES = 1024;
+    static constexpr size_t MAX_SAMPLES = size_t(1) << 20;
+    static constexpr size_t OVERSAMPLE = 8;  // samples per period of the highest frequency
+    static constexpr size_t REBUILD_INTERVAL = 4096;  // incremental terms between full rebuilds
+
+    void Build(const std::vector<Epicycle>& epis, size_t count, unsigned threads = 0) {
+        count = std::min(count, epis.size());
+        int maxFreq = 0;
+        for (size_t i = 0; i < count; ++i) maxFreq = std::max(maxFreq, std::abs(epis[i].frequency));
+
+        M = MIN_SAMPLES;
+        while (M < OVERSAMPLE * (size_t)maxFreq && M < MAX_SAMPLES) M *= 2;
+
+        // Bin f (mod M) holds the coefficient; the unnormalized inverse FFT
+        // then evaluates sum(value * e^(i * freq * 2pi * j / M)) at every j.
+        std::vector<std::complex<double>> bins(M), slopeBins(M);
+        for (size_t i = 0; i < count; ++i) {
+            const int f = epis[i].frequency;
+            const size_t k = (size_t)(((long long)f % (long long)M + (long long)M) % (long long)M);
+            bins[k] += epis[i].value;
+            slopeBins[k] += epis[i].value * std::complex<double>(0.0, 2.0 * M_PI * f);
+        }
+
+        threads = Parallel::Resolve(threads);
+        auto plan = FFTPlan::Get(M);
+        points.resize(M);
+        slopes.resize(M);
+        plan->Inverse(bins.data(), points.data(), threads);
+        plan->Inverse(slopeBins.data(), slopes.data(), threads);
+
+        builtCount = count;
+        patchedTerms = 0;
+    }
+
+    // Moves the table to `count` circles, incrementally where possible.
+    void SetCount(const std::vector<Epicycle>& epis, size_t count, unsigned threads = 0) {
+        count = std::min(count, epis.size());
+        if (M != 0 && count == builtCount) return;
+
+        const size_t lo = std::min(count, builtCount), hi = std::max(count, builtCount);
+        const size_t terms = hi - lo;
+        size_t log2M = 0;
+        while ((size_t(1) << log2M) < M) ++log2M;
+
+        // Two inverse FFTs cost ~M log2(M); each patched term costs ~M
+        bool incremental = M != 0 && terms <= log2M && patchedTerms + terms <= REBUILD_INTERVAL;
+        if (incremental && count > builtCount && M < MAX_SAMPLES) {
+            for (size_t i = lo; i < hi; ++i) {
+                if (OVERSAMPLE * (size_t)std::abs(epis[i].frequency) > M) incremental = false;
+            }
+        }
+        if (!incremental) {
+            Build(epis, count, threads);
+            return;
+        }
+
+        if (twiddles.size() != M) {
+            twiddles.resize(M);
+            for (size_t j = 0; j < M; ++j) {
+                const double angle = 2.0 * M_PI * (double)j / (double)M;
+                twiddles[j] = std::complex<double>(std::cos(angle), std::sin(angle));
+            }
+        }
+
+        const double sign = count > builtCount ? 1.0 : -1.0;
+        Parallel::For(0, M, Parallel::Resolve(threads), 65536, [&](size_t jLo, size_t jHi) {
+            for (size_t i = lo; i < hi; ++i) {
+                const int f = epis[i].frequency;
+                const double cRe = sign * epis[i].value.real(), cIm = sign * epis[i].value.imag();
+                const double dRe = -2.0 * M_PI * f * cIm, dIm = 2.0 * M_PI * f * cRe;  // c * i*2pi*f
+                const size_t stride = (size_t)(((long long)f % (long long)M + (long long)M) % (long long)M);
+
+                // Sample j gains c * e^(i * 2pi * f * j / M) = c * twiddles[f * j mod M]
+                size_t idx = (stride * jLo) & (M - 1);
+                for (size_t j = jLo; j < jHi; ++j) {
+                    const double wRe = twiddles[idx].real(), wIm = twiddles[idx].imag();
+                    points[j] += std::complex<double>(cRe * wRe - cIm * wIm, cRe * wIm + cIm * wRe);
+                    slopes[j] += std::complex<double>(dRe * wRe - dIm * wIm, dRe * wIm + dIm * wRe);
+                    idx = (idx + stride) & (M - 1);
+                }
+            }
+        });
+
+        builtCount = count;
+        patchedTerms += terms;
+    }
+
+    void Clear() { points.clear(); slopes.clear(); M = 0; builtCount = 0; patchedTerms = 0; }
+
+    bool Empty() const { return M == 0; }
+    size_t Count() const { return builtCount; }
+    size_t Samples() const { return M; }
+
+    // Curve position at t (any real t; the curve has period 1).
+    std::complex<double> At(double t) const {
+        if (M == 0) return {};
+        double u = (t - std::floor(t)) * (double)M;
+        size_t j = std::min((size_t)u, M - 1);
+        const double s = u - (double)j;
+        const size_t j1 = (j + 1) & (M - 1);
+        const double h = 1.0 / (double)M;
+
+        // Cubic Hermite basis
+        const double s2 = s * s, s3 = s2 * s;
+        const double h00 = 2.0 * s3 - 3.0 * s2 + 1.0;
+        const double h10 = s3 - 2.0 * s2 + s;
+        const double h01 = -2.0 * s3 + 3.0 * s2;
+        const double h11 = s3 - s2;
+        return h00 * points[j] + (h10 * h) * slopes[j] + h01 * points[j1] + (h11 * h) * slopes[j1];
+    }
+
+    // The trail the pen leaves up to time t (0 <= t < 1), thinned so
+    // neighbouring points are more than minSpacing apart, like the live trail.
+    // maxPoints = 0 traces from t = 0 (cleared on every loop); otherwise the
+    // last maxPoints points, reaching back across the loop if needed.
+    std::vector<glm::vec2> Trace(double t, float minSpacing, size_t maxPoints) const {
+        std::vector<glm::vec2> out;
+        if (M == 0) return out;
+        const double u = (t - std::floor(t)) * (double)M;
+        const size_t last = std::min((size_t)u, M - 1);
+        auto toVec = [](std::complex<double> c) { return glm::vec2((float)c.real(), (float)c.imag()); };
+
+        if (maxPoints == 0) {
+            for (size_t j = 0; j <= last; ++j) {
+                glm::vec2 p = toVec(points[j]);
+                if (out.empty() || glm::distance(out.back(), p) > minSpacing) out.push_back(p);
+            }
+            glm::vec2 tip = toVec(At(t));
+            if (glm::distance(out.back(), tip) > minSpacing) out.push_back(tip);
+            return out;
+        }
+
+        out.push_back(toVec(At(t)));
+        for (size_t step = 0; step < M && out.size() < maxPoints; ++step) {
+            glm::vec2 p = toVec(points[(last + M - step) & (M - 1)]);
+            if (glm::distance(out.back(), p) > minSpacing) out.push_back(p);
+        }
+        std::reverse(out.begin(), out.end());
+        return out;
+    }
+
+private:
+    size_t M = 0;
+    std::vector<std::complex<double>> points, slopes;
+    std::vector<std::complex<double>> twiddles;  // e^(2pi i j / M), built on first incremental update
+    size_t builtCount = 0;
+    size_t patchedTerms = 0;
+};
+
 class FourierTransform {
 public:
-    static std::vector<Epicycle> ComputeDFT(const std::vector<glm::vec2>& path) {
+    // threads = 0 uses Parallel::ThreadCount(). Output is bit-identical
+    // for every thread count. `fidelity` keeps only the largest circles
+    // needed to meet it (all of them by default).
+    static std::vector<Epicycle> ComputeDFT(const std::vector<glm::vec2>& path, unsigned threads = 0,
+                                            const Fidelity& fidelity = {}) {
         size_t N = path.size();
-        std::vector<Epicycle> fourier(N);
+        if (N == 0) return {};
+        if (fidelity.mode == Fidelity::Mode::Band && 2 * (size_t)fidelity.value + 1 < N) {
+            return ComputeBand(path, (int)fidelity.value, threads);
+        }
+        threads = Parallel::Resolve(threads);
+
+        // FFT: O(N log N) for any N (plans are cached per sample count)
+        auto plan = FFTPlan::Get(N);
+        std::vector<std::complex<double>> signal(N), spectrum(N);
+        for (size_t n = 0; n < N; ++n) {
+            signal[n] = std::complex<double>(path[n].x, path[n].y);
+        }
+        plan->Forward(signal.data(), spectrum.data(), threads);
+
+        return ToEpicycles(spectrum.data(), N, threads, fidelity);
+    }
 
-        // Basic O(N^2) DFT
-        // For N=3000, operations ~= 9,000,000 (Fast enough for background thread)
-        for (int k = 0; k < (int)N; ++k) {
-            std::complex<double> sum(0, 0);
-            
-            // Remap frequency k: 0, 1... N/2, -N/2 ... -1
-            int freq = k;
-            if (k > (int)N / 2) freq -= N;
+    // Only frequencies -maxFreq..maxFreq, amplitude-sorted. BandDFT evaluates
+    // just those bins (Goertzel for a few, a pruned FFT for more), so the
+    // cost follows the band size rather than N.
+    static std::vector<Epicycle> ComputeBand(const std::vector<glm::vec2>& path, int maxFreq, unsigned threads = 0) {
+        std::vector<int> freqs;
+        for (int f = -std::max(maxFreq, 0); f <= std::max(maxFreq, 0); ++f) freqs.push_back(f);
+        return ComputeFrequencies(path, freqs, threads);
+    }
+
+    // The `count` lowest frequencies (0, 1, -1, 2, -2, ...), amplitude-sorted.
+    static std::vector<Epicycle> ComputeLowest(const std::vector<glm::vec2>& path, size_t count, unsigned threads = 0) {
+        std::vector<int> freqs;
+        for (size_t i = 0; i < count; ++i) freqs.push_back(i % 2 ? (int)(i / 2 + 1) : -(int)(i / 2));
+        return ComputeFrequencies(path, freqs, threads);
+    }
 
-            for (int n = 0; n < (int)N; ++n) {
-                double phi = (2.0 * M_PI * k * n) / N;
-                std::complex<double> c(path[n].x, path[n].y);
-                // e^(-i * phi) = cos(phi) - i*sin(phi)
-                sum += c * std::complex<double>(std::cos(phi), -std::sin(phi));
+    // Coefficients -maxFreq..maxFreq of the curve traced at constant speed
+    // along the cubics, straight from the control points. With s the arc
+    // length and T the total,
+    //     c_k = (1/T) * integral of z(s) e^(-2pi i k s / T) ds
+    // Segments are split at sharp turns, reparameterized by arc length
+    // (ArcLengthTable) and integrated with 8-point Gauss-Legendre in s, on
+    // spans short enough that e^(-2pi i k s / T) turns at most ~1/6 of a
+    // cycle across one at maxFreq. Cost is O((segments + maxFreq) *
+    // maxFreq); nothing is resampled. In a cancelled scope
+    // (ThreadPool::Cancelled) it stops early and returns nothing.
+    static std::vector<Epicycle> ComputeFromCubics(const std::vector<Cubic>& cubics, int maxFreq, unsigned threads = 0,
+                                                   const Fidelity& fidelity = {}) {
+        if (cubics.empty()) return {};
+        maxFreq = std::max(maxFreq, 0);
+        threads = Parallel::Resolve(threads);
+
+        // Split at cusps and tight turns so every piece is smooth in s
+        std::vector<Cubic> pieces;
+        for (const auto& c : cubics) {
+            if (ThreadPool::Cancelled()) return {};
+            Cubic rest = c;
+            double consumed = 0.0;
+            for (double u : c.SharpTurns()) {
+                auto halves = rest.Split((u - consumed) / (1.0 - consumed));
+                pieces.push_back(halves.first);
+                rest = halves.second;
+                consumed = u;
             }
+            pieces.push_back(rest);
+        }
 
-            sum /= (double)N;
+        std::vector<ArcLengthTable> tables;
+        tables.reserve(pieces.size());
+        double T = 0.0;
+        for (const auto& c : pieces) {
+            if (ThreadPool::Cancelled()) return {};
+            tables.emplace_back(c);
+            T += tables.back().Length();
+        }
+        if (!(T > 0.0)) return {};
 
-            fourier[k] = {
-                sum,
-                freq,
-                (float)std::abs(sum),
-                (float)std::arg(sum)
-            };
+        // Quadrature nodes: weight * z, and arc length position s
+        std::vector<std::complex<double>> weighted;
+        std::vector<double> position;
+        double segStart = 0.0;
+        for (size_t i = 0; i < pieces.size(); ++i) {
+            if (ThreadPool::Cancelled()) return {};
+            const double len = tables[i].Length();
+            const int spans = 1 + (int)std::ceil(CUBIC_SPANS_PER_CYCLE * maxFreq * len / T);
+            const double half = 0.5 * len / spans;
+            for (int p = 0; p < spans && len > 0.0; ++p) {
+                const double mid = (2 * p + 1) * half;
+                for (int g = 0; g < GaussLegendre::ORDER; ++g) {
+                    const double s = mid + half * GaussLegendre::NODES[g];
+                    const glm::dvec2 z = pieces[i].Point(tables[i].ParamAt(s));
+                    const double w = half * GaussLegendre::WEIGHTS[g];
+                    weighted.emplace_back(w * z.x, w * z.y);
+                    position.push_back(segStart + s);
+                }
+            }
+            segStart += len;
         }
 
-        // Sort by amplitude (Largest circles first)
-        std::sort(fourier.begin(), fourier.end(), [](const Epicycle& a, const Epicycle& b) {
-            return a.amp > b.amp;
+        // Nonuniform DFT over the nodes. Each block of frequencies starts
+        // every node at its exact phase, then steps by e^(-2pi i s / T).
+        const size_t K = 2 * (size_t)maxFreq + 1;
+        std::vector<Epicycle> fourier(K);
+        Parallel::For(0, K, threads, 64, [&](size_t lo, size_t hi) {
+            for (size_t blockLo = lo; blockLo < hi && !ThreadPool::Cancelled(); blockLo += CUBIC_FREQ_BLOCK) {
+                const size_t blockHi = std::min(hi, blockLo + CUBIC_FREQ_BLOCK);
+                const int firstFreq = (int)blockLo - maxFreq;
+                std::vector<std::complex<double>> acc(blockHi - blockLo);
+
+                for (size_t j = 0; j < weighted.size(); ++j) {
+                    if (j % CUBIC_CANCEL_NODES == 0 && ThreadPool::Cancelled()) break;
+                    const double turns = position[j] / T;
+                    double startTurns = (double)firstFreq * turns;
+                    startTurns -= std::floor(startTurns);
+                    const std::complex<double> step = std::polar(1.0, -2.0 * M_PI * turns);
+                    std::complex<double> cur = std::polar(1.0, -2.0 * M_PI * startTurns) * weighted[j];
+                    for (size_t k = 0; k < acc.size(); ++k) {
+                        acc[k] += cur;
+                        cur = std::complex<double>(cur.real() * step.real() - cur.imag() * step.imag(),
+                                                   cur.real() * step.imag() + cur.imag() * step.real());
+                    }
+                }
+                for (size_t k = 0; k < acc.size(); ++k) {
+                    fourier[blockLo + k] = MakeEpicycle(acc[k] / T, firstFreq + (int)k, 1);
+                }
+            }
         });
+        if (ThreadPool::Cancelled()) return {};
 
+        Finish(fourier, fidelity);
         return fourier;
     }
+
+    // M equal-length signals transformed together. Layout is interleaved by
+    // signal: signals[n * M + m] is sample n of signal m. Each SIMD lane of
+    // the batched FFT carries a different signal, which keeps the vector
+    // units full even when a single transform is short.
+    static std::vector<std::vector<Epicycle>> ComputeDFTBatch(const std::vector<glm::vec2>& signals, size_t M,
+                                                              unsigned threads = 0, const Fidelity& fidelity = {}) {
+        if (M == 0 || signals.size() % M != 0) return {};
+        const size_t N = signals.size() / M;
+        std::vector<std::vector<Epicycle>> result(M);
+        if (N == 0) return result;
+
+        const size_t lanes = Simd::PadLanes(M);
+        Simd::AlignedVector<double> re(N * lanes, 0.0), im(N * lanes, 0.0);
+        Simd::AlignedVector<double> outRe(N * lanes), outIm(N * lanes);
+        for (size_t n = 0; n < N; ++n) {
+            for (size_t m = 0; m < M; ++m) {
+                re[n * lanes + m] = signals[n * M + m].x;
+                im[n * lanes + m] = signals[n * M + m].y;
+            }
+        }
+
+        FFTPlan::Get(N)->ForwardBatch(re.data(), im.data(), outRe.data(), outIm.data(), lanes);
+
+        Parallel::For(0, M, Parallel::Resolve(threads), 1, [&](size_t lo, size_t hi) {
+            std::vector<std::complex<double>> spectrum(N);
+            for (size_t m = lo; m < hi; ++m) {
+                for (size_t k = 0; k < N; ++k) {
+                    spectrum[k] = std::complex<double>(outRe[k * lanes + m], outIm[k * lanes + m]);
+                }
+                result[m] = ToEpicycles(spectrum.data(), N, 1, fidelity);
+            }
+        });
+        return result;
+    }
+
+    // Independent signals of any lengths (outline parts), one transform per
+    // worker. A single signal keeps the threaded transform instead. A
+    // cancelled scope stops between signals, leaving the rest empty.
+    static std::vector<std::vector<Epicycle>> ComputeDFTEach(const std::vector<std::vector<glm::vec2>>& signals,
+                                                             unsigned threads = 0, const Fidelity& fidelity = {}) {
+        std::vector<std::vector<Epicycle>> result(signals.size());
+        if (signals.size() == 1) {
+            result[0] = ComputeDFT(signals[0], threads, fidelity);
+            return result;
+        }
+        Parallel::For(0, signals.size(), Parallel::Resolve(threads), 1, [&](size_t lo, size_t hi) {
+            for (size_t i = lo; i < hi && !ThreadPool::Cancelled(); ++i) {
+                result[i] = ComputeDFT(signals[i], 1, fidelity);
+            }
+        });
+        return result;
+    }
+
+    // The circles `fidelity` keeps out of a full amplitude-sorted spectrum,
+    // still sorted: what computing with that target would have returned,
+    // without transforming again. Band keeps |frequency| <= F.
+    static std::vector<Epicycle> Select(const std::vector<Epicycle>& sorted, const Fidelity& fidelity) {
+        if (fidelity.mode == Fidelity::Mode::Band) {
+            std::vector<Epicycle> kept;
+            for (const auto& e : sorted) {
+                if (std::abs(e.frequency) <= (int)fidelity.value) kept.push_back(e);
+            }
+            return kept;
+        }
+        std::vector<Epicycle> kept = sorted;
+        Finish(kept, fidelity);
+        return kept;
+    }
+
+private:
+    static constexpr double CUBIC_SPANS_PER_CYCLE = 6.0;  // quadrature spans per cycle of maxFreq
+    static constexpr size_t CUBIC_FREQ_BLOCK = 256;        // phase recurrence length before a fresh start
+    static constexpr size_t CUBIC_CANCEL_NODES = 4096;     // nodes between cancellation checks
+
+    static Epicycle MakeEpicycle(std::complex<double> bin, int freq, size_t N) {
+        std::complex<double> sum = bin / (double)N;
+        return { sum, freq, (float)std::abs(sum), (float)std::arg(sum) };
+    }
+
+    // Distinct frequencies; falls back to the full transform once they
+    // cover every bin.
+    static std::vector<Epicycle> ComputeFrequencies(const std::vector<glm::vec2>& path, const std::vector<int>& freqs,
+                                                    unsigned threads) {
+        const size_t N = path.size();
+        if (N == 0) return {};
+        if (freqs.size() >= N) return ComputeDFT(path, threads);
+        threads = Parallel::Resolve(threads);
+
+        std::vector<std::complex<double>> signal(N), bins(freqs.size());
+        for (size_t n = 0; n < N; ++n) {
+            signal[n] = std::complex<double>(path[n].x, path[n].y);
+        }
+        std::vector<size_t> index(freqs.size());
+        for (size_t i = 0; i < freqs.size(); ++i) {
+            index[i] = (size_t)(((long long)freqs[i] % (long long)N + (long long)N) % (long long)N);
+        }
+        BandDFT::Compute(signal.data(), N, index, bins.data(), threads);
+
+        std::vector<Epicycle> fourier(freqs.size());
+        for (size_t i = 0; i < freqs.size(); ++i) fourier[i] = MakeEpicycle(bins[i], freqs[i], N);
+        Finish(fourier, Fidelity::All());
+        return fourier;
+    }
+
+    // Unnormalized FFT bins -> amplitude-sorted epicycles.
+    static std::vector<Epicycle> ToEpicycles(const std::complex<double>* spectrum, size_t N, unsigned threads,
+                                             const Fidelity& fidelity) {
+        std::vector<Epicycle> fourier(N);
+
+        Parallel::For(0, N, threads, 16384, [&](size_t lo, size_t hi) {
+            for (int k = (int)lo; k < (int)hi; ++k) {
+                // Remap frequency k: 0, 1... N/2, -N/2 ... -1
+                int freq = k;
+                if (k > (int)N / 2) freq -= N;
+
+                fourier[k] = MakeEpicycle(spectrum[k], freq, N);
+            }
+        });
+
+        Finish(fourier, fidelity);
+        return fourier;
+    }
+
+    // Sort by amplitude (Largest circles first). With a fidelity target
+    // only the kept prefix is ordered; the rest is dropped unsorted.
+    static void Finish(std::vector<Epicycle>& fourier, const Fidelity& fidelity) {
+        size_t keep = SelectCount(fourier, fidelity);
+        std::sort(fourier.begin(), fourier.begin() + keep, [](const Epicycle& a, const Epicycle& b) {
+            return a.amp > b.amp;
+        });
+        if (keep < fourier.size()) {
+            fourier.resize(keep);
+            fourier.shrink_to_fit();
+        }
+    }
+
+    // Smallest K whose K largest circles meet the target. Moves those K to
+    // the front (unordered) by repeated nth_element partitioning, so the
+    // cost is O(N) expected instead of a full sort.
+    static size_t SelectCount(std::vector<Epicycle>& fourier, const Fidelity& fidelity) {
+        const size_t N = fourier.size();
+        if (fidelity.mode == Fidelity::Mode::All || fidelity.mode == Fidelity::Mode::Band || N == 0) return N;
+
+        auto energy = [](const Epicycle& e) { return std::norm(e.value); };
+        double total = 0.0;
+        for (const auto& e : fourier) total += energy(e);
+
+        // Energy the kept circles must carry
+        double need;
+        if (fidelity.mode == Fidelity::Mode::RMS) {
+            need = total - fidelity.value * fidelity.value;
+        } else {
+            need = total * std::clamp(fidelity.value, 0.0, 1.0);
+        }
+        if (need <= 0.0) {  // the largest circle alone is within target
+            auto smaller = [&](const Epicycle& a, const Epicycle& b) { return energy(a) < energy(b); };
+            std::iter_swap(fourier.begin(), std::max_element(fourier.begin(), fourier.end(), smaller));
+            return 1;
+        }
+        if (need >= total) return N;
+
+        // Invariant: [0, lo) is kept, and the answer lies in [lo, hi]
+        auto larger = [](const Epicycle& a, const Epicycle& b) { return std::norm(a.value) > std::norm(b.value); };
+        size_t lo = 0, hi = N;
+        while (hi - lo > 1) {
+            size_t mid = lo + (hi - lo) / 2;
+            std::nth_element(fourier.begin() + lo, fourier.begin() + mid, fourier.begin() + hi, larger);
+            double upper = 0.0;
+            for (size_t i = lo; i < mid; ++i) upper += energy(fourier[i]);
+
+            if (upper >= need) {
+                hi = mid;
+            } else {
+                need -= upper;
+                lo = mid;
+            }
+        }
+        return std::max<size_t>(1, lo + (need > 0.0 ? 1 : 0));
+    }
 };
\ No newline at end of file
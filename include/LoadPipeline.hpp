@@ -0,0 +1,542 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <glm/glm.hpp>
+
+#include "FourierCore.hpp"
+#include "SVGParser.hpp"
+#include "SVGStream.hpp"
+#include "SpectrumCache.hpp"
+#include "ThreadPool.hpp"
+
+// --- Load Settings / Result ---
+struct LoadOptions {
+    Fidelity fidelity;
+    bool exactBezier = false;  // integrate the cubics directly instead of sampling
+    int maxFreq = 1000;        // band computed in exact mode
+    SVGParser::ParseMode parseMode = SVGParser::ParseMode::Auto;
+    bool separateParts = false;  // one chain per subpath instead of one joined loop
+    bool reorder = false;        // shorten the jumps between joined subpaths
+    int samples = SVGParser::ADAPTIVE;  // outline samples; ADAPTIVE sizes them to the curve
+};
+
+struct LoadedData {
+    std::string path;
+    std::vector<std::vector<glm::vec2>> parts;  // one signal per chain
+    std::vector<std::vector<Epicycle>> spectra;
+    size_t coefficients = 0;  // before fidelity truncation
+    bool partial = false;     // coarse preview of a load still running
+};
+
+// --- Load Job ---
+// One load running in the background. The UI polls it for progress and
+// snapshots and may cancel it at any time. The pipeline runs under the
+// job's cancellation flag (ThreadPool::Scope), which the parser, sampler
+// and transform loops check between chunks, so a superseded load stops
+// within one chunk of work instead of running to the end.
+//
+// Snapshots go through a single-slot mailbox, an atomic pointer both sides
+// exchange, so neither ever waits on the other: the loader replaces any
+// snapshot the UI has not taken yet, and the UI always gets the newest.
+// Coarse previews (LoadedData::partial) come first; the last snapshot is
+// the finished load, published even when it failed or was cancelled.
+class LoadJob {
+public:
+    enum class Stage : uint32_t { Queued, Cache, Parse, Outline, Resample, Transform, Select };
+
+    struct Progress {
+        Stage stage = Stage::Queued;
+        uint32_t done = 0, total = 0;  // sampling passes or parts; total is 0 when unknown
+    };
+
+    explicit LoadJob(std::string filepath) : path(std::move(filepath)) {}
+    ~LoadJob() { delete mailbox.exchange(nullptr); }
+    LoadJob(const LoadJob&) = delete;
+    LoadJob& operator=(const LoadJob&) = delete;
+
+    const std::string& Path() const { return path; }
+
+    // --- UI Side ---
+    void Cancel() { cancelled.store(true, std::memory_order_relaxed); }
+    bool Cancelled() const { return cancelled.load(std::memory_order_relaxed); }
+    bool Finished() const { return finished.load(std::memory_order_acquire); }
+    void Wait() const { finished.wait(false, std::memory_order_acquire); }
+
+    Progress Status() const {
+        const uint64_t packed = progress.load(std::memory_order_relaxed);
+        return { (Stage)(packed >> 56), (uint32_t)((packed >> 28) & COUNT_MASK), (uint32_t)(packed & COUNT_MASK) };
+    }
+
+    static const char* StageName(Stage stage) {
+        switch (stage) {
+            case Stage::Queued: return "Waiting for previous load";
+            case Stage::Cache: return "Reading cache";
+            case Stage::Parse: return "Parsing SVG";
+            case Stage::Outline: return "Building outline";
+            case Stage::Resample: return "Sampling";
+            case Stage::Transform: return "Calculating DFT";
+            case Stage::Select: return "Selecting circles";
+        }
+        return "";
+    }
+
+    // Newest snapshot not taken yet, or null.
+    std::unique_ptr<LoadedData> Take() {
+        return std::unique_ptr<LoadedData>(mailbox.exchange(nullptr, std::memory_order_acq_rel));
+    }
+
+    // --- Loader Side ---
+    const std::atomic<bool>* CancelFlag() const { return &cancelled; }
+    void SetStage(Stage stage, uint32_t total = 0) { progress.store(Pack(stage, 0, total), std::memory_order_relaxed); }
+    void SetDone(uint32_t done) {  // only the loader writes progress, so this cannot race
+        const Progress p = Status();
+        progress.store(Pack(p.stage, done, p.total), std::memory_order_relaxed);
+    }
+    void Publish(LoadedData data) {
+        delete mailbox.exchange(new LoadedData(std::move(data)), std::memory_order_acq_rel);
+    }
+    void Finish() {
+        finished.store(true, std::memory_order_release);
+        finished.notify_all();
+    }
+
+private:
+    // Stage in the top 8 bits, then done and total in 28 bits each, so a
+    // reader never sees one stage's count with another's total.
+    static constexpr uint64_t COUNT_MASK = (uint64_t(1) << 28) - 1;
+    static uint64_t Pack(Stage stage, uint64_t done, uint64_t total) {
+        return (uint64_t)stage << 56 | std::min(done, COUNT_MASK) << 28 | std::min(total, COUNT_MASK);
+    }
+
+    const std::string path;
+    std::atomic<bool> cancelled{false}, finished{false};
+    std::atomic<uint64_t> progress{0};
+    std::atomic<LoadedData*> mailbox{nullptr};
+    static_assert(std::atomic<LoadedData*>::is_always_lock_free && std::atomic<uint64_t>::is_always_lock_free,
+                  "the snapshot handoff must not take a lock");
+};
+
+// --- Staged Load Pipeline ---
+// A load runs as five stages, each memoizing its last result under a key
+// made of the file's content hash and the settings that stage (and every
+// stage before it) depends on:
+//
+//   parse      the open document (SVGParser::Document)  hash, front end
+//   outline    ordered, normalized or split cubics      + reorder, separate
+//                                                         parts, exact mode
+//   resample   arc-length samples per part              + sample count
+//   transform  amplitude-sorted spectra                 + band
+//   select     circles the fidelity target keeps (always rerun; no transform)
+//
+// The transform covers every frequency, except for a band -F..F: exact
+// mode's band, or F of a Band fidelity target, which then only evaluates
+// the bins it keeps instead of the whole spectrum.
+//
+// Changing the sample count reruns resample and transform only; changing
+// the fidelity target reruns selection only (and the transform, cheaply,
+// when a Band target's F changes). Flattening is not a stage of its own:
+// OutlineSampler flattens each segment while it resamples, so no point
+// buffer sits between the two. The file is still read once per run to hash
+// it, which costs far less than parsing it.
+//
+// The parse stage keeps the document, not its segments: the SVGStream run
+// index or the nanosvg image is a fraction of the size of the cubics. The
+// default joined outline is sampled straight out of it, and the outline
+// stage only builds cubic lists when reordering, separate parts or exact
+// mode need them.
+//
+// Finished transforms also go to SpectrumCache on disk, so reopening a
+// file with the same settings, even in a later session, skips straight to
+// selection; parse and outline then only run if a later change needs them.
+//
+// Run under a LoadJob, the pipeline reports its stage, stops when the job
+// is cancelled (keeping only stages that completed), and publishes coarse
+// previews: every adaptive sampling pass is a usable outline at a lower
+// sample count, and a single signal with no such passes (exact mode, a
+// fixed sample count) first shows its lowest PREVIEW_FREQ frequencies.
+class LoadPipeline {
+public:
+    static constexpr auto PREVIEW_INTERVAL = std::chrono::milliseconds(50);  // between published previews
+    static constexpr int PREVIEW_FREQ = 64;  // band of a single signal's first preview
+
+    // Queues a load and returns the job following it. Loads run one at a
+    // time as Background pool tasks: while one runs, the newest request
+    // waits in a single pending slot, and the finishing task submits it. A
+    // request still waiting there when another arrives is superseded: its
+    // job is cancelled and finishes without running. No task ever waits
+    // for another load, so a load never holds a worker idle.
+    //
+    // The pipeline must outlive every job it starts.
+    std::shared_ptr<LoadJob> Start(const std::string& path, const LoadOptions& options) {
+        auto job = std::make_shared<LoadJob>(path);
+        Request superseded;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            superseded = std::move(pending);
+            pending = { job, options };
+            if (!running) {
+                running = true;
+                Launch(TakePending());
+            }
+        }
+        if (superseded.job) {
+            LoadedData empty;
+            empty.path = superseded.job->Path();
+            superseded.job->Cancel();
+            superseded.job->Publish(std::move(empty));
+            superseded.job->Finish();
+        }
+        return job;
+    }
+
+private:
+    struct Request {
+        std::shared_ptr<LoadJob> job;
+        LoadOptions options;
+    };
+
+    Request TakePending() {  // with the mutex held
+        Request request = std::move(pending);
+        pending = {};
+        return request;
+    }
+
+    // Runs `request` as a pool task that hands the slot on when done: it
+    // submits the pending request, if any, before finishing its own job.
+    void Launch(Request request) {
+        ThreadPool::Scope scope(ThreadPool::Lane::Background, "load", nullptr);
+        ThreadPool::Submit([this, request = std::move(request)]() {
+            request.job->Publish(Run(request.job->Path(), request.options, request.job.get()));
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (pending.job) {
+                    Launch(TakePending());
+                } else {
+                    running = false;
+                }
+            }
+            request.job->Finish();
+        });
+    }
+
+    LoadedData Run(const std::string& path, const LoadOptions& options, LoadJob* job) {
+        LoadedData data;
+        data.path = path;
+
+        auto stage = [&](LoadJob::Stage s, uint32_t total = 0) {
+            if (job) job->SetStage(s, total);
+        };
+        bool stopped = false;
+        auto cancelled = [&]() {
+            if (stopped || !job || !job->Cancelled()) return stopped;
+            std::cout << "Load cancelled: " << path << std::endl;
+            return stopped = true;
+        };
+        if (cancelled()) return data;  // cancelled while waiting in the pending slot
+
+        // Every loop below stops early once the job is cancelled; results
+        // from then on are incomplete and never stored
+        ThreadPool::Scope cancelScope("load", job ? job->CancelFlag() : nullptr);
+
+        stage(LoadJob::Stage::Cache);
+        MappedFile file;
+        if (!file.Open(path)) {
+            std::cerr << "Failed to open SVG file." << std::endl;
+            return data;
+        }
+        const uint64_t hash = file.Hash();
+        file.Close();
+
+        std::string ran;
+        auto mark = [&](const char* label) { ran += ran.empty() ? label : std::string(", ") + label; };
+
+        const ParseKey parseKey{ hash, options.parseMode };
+        const OutlineKey outlineKey{ parseKey, options.separateParts && !options.exactBezier, options.reorder,
+                                     options.exactBezier };
+        const ResampleKey resampleKey{ outlineKey, options.exactBezier ? 0 : options.samples };
+        const bool banded = options.fidelity.mode == Fidelity::Mode::Band;
+        int band = TransformKey::ALL;  // exact mode's band, a Band target's F, or every frequency
+        if (options.exactBezier) {
+            band = options.maxFreq;
+        } else if (banded) {
+            band = (int)options.fidelity.value;
+        }
+        const TransformKey transformKey{ resampleKey, band };
+        const SpectrumCache::Key diskKey{ hash, SettingsHash(transformKey), resampleKey.samples };
+
+        // 0. On-disk cache: a finished load with the same file and settings
+        if (!transformed.Valid(transformKey)) {
+            std::vector<std::vector<glm::vec2>> parts;
+            std::vector<std::vector<Epicycle>> spectra;
+            if (SpectrumCache::Load(diskKey, parts, spectra)) {
+                mark("disk cache");
+                resampled.Store(resampleKey, std::move(parts));
+                transformed.Store(transformKey, std::move(spectra));
+            }
+        }
+
+        // 1. Parse, when a later stage needs the document
+        auto needDocument = [&]() {
+            if (!parsed.Valid(parseKey)) {
+                mark("parse");
+                stage(LoadJob::Stage::Parse);
+                ThreadPool::Scope scope("parse");
+                auto document = SVGParser::Document::Open(path, options.parseMode);
+                if (cancelled()) return false;
+                parsed.Store(parseKey, std::move(document));
+            }
+            return parsed.Valid(parseKey);
+        };
+
+        // 2. Outline: subpaths in SubpathOrder's order (reorder), the
+        // normalized parts (separate parts), or the normalized joined cubics
+        // (exact mode). A plain joined outline has no outline stage; it is
+        // sampled straight from the document.
+        const bool streamed = !outlineKey.exact && !outlineKey.separateParts && !outlineKey.reorder;
+        auto needOutline = [&]() {
+            if (outline.Valid(outlineKey)) return !outline.value->empty();
+            if (!needDocument()) return false;
+            mark("outline");
+            stage(LoadJob::Stage::Outline);
+            ThreadPool::Scope scope("outline");
+            std::vector<std::vector<Cubic>> parts;
+            if (outlineKey.exact) {
+                std::vector<Cubic> joined;
+                if (outlineKey.reorder) {
+                    std::vector<std::vector<Cubic>> subpaths = SVGParser::Subpaths(*parsed.value);
+                    SVGParser::Reorder(subpaths);
+                    joined = SVGParser::Join(subpaths);
+                } else {
+                    parsed.value->Visit([&](const auto& source) { joined = SVGParser::Join(source); });
+                }
+                if (!joined.empty()) parts.push_back(std::move(joined));
+                SVGParser::NormalizeSubpaths(parts);
+            } else {
+                parts = SVGParser::Subpaths(*parsed.value);
+                if (outlineKey.reorder) SVGParser::Reorder(parts);
+                if (outlineKey.separateParts && !parts.empty()) {
+                    SVGParser::NormalizeSubpaths(parts);
+                    parts = SVGParser::SplitParts(std::move(parts));
+                }
+            }
+            if (cancelled()) return false;
+            outline.Store(outlineKey, std::move(parts));
+            return !outline.value->empty();
+        };
+
+        // 3. Resample (exact mode keeps the cubics; the samples are only its
+        //    ghost outline)
+        if (!resampled.Valid(resampleKey)) {
+            if (!(streamed ? needDocument() : needOutline())) {
+                if (!cancelled()) std::cerr << "No path data found in SVG." << std::endl;
+                return data;
+            }
+            if (cancelled()) return data;
+            mark("resample");
+            ThreadPool::Scope scope("resample");
+            if (options.exactBezier) {
+                stage(LoadJob::Stage::Resample);
+                resampled.Store(resampleKey, { OutlineSampler::Flatten(outline.value->front(), 0.1) });
+            } else {
+                // Passes of a single part count towards the largest
+                // adaptive count; several parts count as they finish
+                const size_t partCount = outlineKey.separateParts ? outline.value->size() : 1;
+                uint32_t passes = 0, levels = 1;
+                if (options.samples <= SVGParser::ADAPTIVE) {
+                    for (int n = SVGParser::ADAPTIVE_MIN; n < SVGParser::ADAPTIVE_MAX; n *= 2) ++levels;
+                }
+                stage(LoadJob::Stage::Resample, partCount == 1 ? levels : (uint32_t)partCount);
+
+                Preview preview;
+                SVGParser::SampleHook hook;
+                if (job) {
+                    hook = [&](size_t part, const std::vector<glm::vec2>& points, bool final) {
+                        job->SetDone(partCount == 1 ? (final ? levels : ++passes) : (uint32_t)part + final);
+                        // A single part's last pass is about to be transformed for real
+                        if (partCount > 1 || !final) {
+                            preview.Update(part, points);
+                            preview.Publish(*job, path, options.fidelity);
+                        }
+                        return !job->Cancelled();
+                    };
+                }
+                std::vector<std::vector<glm::vec2>> samples;
+                if (outlineKey.separateParts) {
+                    samples = SVGParser::SampleParts(*outline.value, options.samples, 0.1f, hook);
+                } else {
+                    SVGParser::PassHook observe;
+                    if (hook) {
+                        observe = [&](const auto& points, bool final) { return hook(0, points, final); };
+                    }
+                    auto sample = [&](const auto& source) {
+                        std::vector<glm::vec2> points = SVGParser::SampleJoined(source, options.samples, 0.1f, observe);
+                        if (!points.empty()) samples.push_back(std::move(points));
+                    };
+                    if (streamed) {
+                        parsed.value->Visit(sample);
+                    } else {
+                        sample(OutlineSampler::SubpathList{ *outline.value });
+                    }
+                }
+                if (cancelled()) return data;
+                if (samples.empty()) {
+                    std::cerr << "No path data found in SVG." << std::endl;
+                    return data;
+                }
+                resampled.Store(resampleKey, std::move(samples));
+            }
+        }
+
+        // 4. Transform
+        if (!transformed.Valid(transformKey)) {
+            if (options.exactBezier && !needOutline()) return data;
+            if (cancelled()) return data;
+            mark("transform");
+            stage(LoadJob::Stage::Transform);
+            ThreadPool::Scope scope("transform");
+            // A single signal is first previewed from its lowest PREVIEW_FREQ
+            // frequencies: exact mode integrates just those, and a fixed
+            // sample count, which had no adaptive passes to preview,
+            // evaluates just those bins
+            auto publishCoarse = [&](const std::vector<Epicycle>& spectrum) {
+                if (cancelled() || spectrum.empty()) return;
+                LoadedData coarse;
+                coarse.path = path;
+                coarse.partial = true;
+                coarse.parts = *resampled.value;
+                coarse.spectra = { FourierTransform::Select(spectrum, options.fidelity) };
+                coarse.coefficients = spectrum.size();
+                job->Publish(std::move(coarse));
+            };
+            std::vector<std::vector<Epicycle>> spectra;
+            if (options.exactBezier) {
+                const std::vector<Cubic>& joined = outline.value->front();
+                if (job && options.maxFreq > PREVIEW_FREQ) {
+                    publishCoarse(FourierTransform::ComputeFromCubics(joined, PREVIEW_FREQ));
+                }
+                if (!cancelled()) spectra = { FourierTransform::ComputeFromCubics(joined, options.maxFreq) };
+            } else {
+                const std::vector<std::vector<glm::vec2>>& parts = *resampled.value;
+                if (job && options.samples > SVGParser::ADAPTIVE && parts.size() == 1 &&
+                    parts[0].size() > 2 * PREVIEW_FREQ + 1 && (!banded || transformKey.band > PREVIEW_FREQ)) {
+                    publishCoarse(FourierTransform::ComputeBand(parts[0], PREVIEW_FREQ));
+                }
+                const Fidelity fidelity = banded ? options.fidelity : Fidelity::All();
+                if (!cancelled()) spectra = FourierTransform::ComputeDFTEach(parts, 0, fidelity);
+            }
+            if (cancelled()) return data;
+            transformed.Store(transformKey, std::move(spectra));
+            SpectrumCache::Store(diskKey, *resampled.value, *transformed.value);
+        }
+
+        // 5. Select
+        stage(LoadJob::Stage::Select);
+        data.parts = *resampled.value;
+        for (const auto& spectrum : *transformed.value) {
+            data.coefficients += spectrum.size();
+            data.spectra.push_back(FourierTransform::Select(spectrum, options.fidelity));
+        }
+        std::cout << "Load stages run: " << (ran.empty() ? "select only" : ran + ", select") << std::endl;
+        return data;
+    }
+
+    struct ParseKey {
+        uint64_t hash = 0;
+        SVGParser::ParseMode mode = SVGParser::ParseMode::Auto;
+        bool operator==(const ParseKey&) const = default;
+    };
+    struct OutlineKey {
+        ParseKey parse;
+        bool separateParts = false, reorder = false, exact = false;
+        bool operator==(const OutlineKey&) const = default;
+    };
+    struct ResampleKey {
+        OutlineKey outline;
+        int samples = 0;
+        bool operator==(const ResampleKey&) const = default;
+    };
+    struct TransformKey {
+        static constexpr int ALL = -1;
+        ResampleKey resample;
+        int band = ALL;  // frequencies -band..band, or ALL
+        bool operator==(const TransformKey&) const = default;
+    };
+
+    // Everything past the content hash that the stored samples and
+    // spectra depend on, for the on-disk cache name.
+    static uint64_t SettingsHash(const TransformKey& key) {
+        const int64_t fields[] = { (int64_t)key.resample.outline.parse.mode, key.resample.outline.separateParts,
+                                   key.resample.outline.reorder, key.resample.samples, key.resample.outline.exact,
+                                   key.band };
+        return MappedFile::Hash((const char*)fields, sizeof(fields));
+    }
+
+    // Coarse snapshot built up from sampling passes: each part's latest
+    // points and their spectrum for the fidelity target. Published at most
+    // every PREVIEW_INTERVAL, transforming only the parts that changed.
+    struct Preview {
+        std::vector<std::vector<glm::vec2>> parts;
+        std::vector<std::vector<Epicycle>> spectra;
+        std::vector<char> dirty;
+        std::chrono::steady_clock::time_point last{};
+
+        void Update(size_t part, const std::vector<glm::vec2>& points) {
+            if (part >= parts.size()) {
+                parts.resize(part + 1);
+                spectra.resize(part + 1);
+                dirty.resize(part + 1, 0);
+            }
+            parts[part] = points;
+            dirty[part] = 1;
+        }
+
+        void Publish(LoadJob& job, const std::string& path, const Fidelity& fidelity) {
+            const auto now = std::chrono::steady_clock::now();
+            if (now - last < PREVIEW_INTERVAL) return;
+            last = now;
+            ThreadPool::Scope scope("preview");
+            LoadedData data;
+            data.path = path;
+            data.partial = true;
+            for (size_t i = 0; i < parts.size(); ++i) {
+                if (dirty[i]) spectra[i] = FourierTransform::ComputeDFT(parts[i], 0, fidelity);
+                dirty[i] = 0;
+                if (spectra[i].empty()) continue;
+                data.parts.push_back(parts[i]);
+                data.spectra.push_back(spectra[i]);
+                data.coefficients += parts[i].size();
+            }
+            if (!data.parts.empty()) job.Publish(std::move(data));
+        }
+    };
+
+    // Last result of one stage and the key it was computed for.
+    template<typename Key, typename Value>
+    struct Stage {
+        Key key;
+        std::shared_ptr<const Value> value;
+
+        bool Valid(const Key& k) const { return value && key == k; }
+        void Store(const Key& k, Value v) { Store(k, std::make_shared<const Value>(std::move(v))); }
+        void Store(const Key& k, std::shared_ptr<const Value> v) {
+            key = k;
+            value = std::move(v);
+        }
+    };
+
+    std::mutex mutex;         // guards the two below; held only to hand the slot on
+    Request pending;          // next load to run
+    bool running = false;     // a load task is queued or running
+    // Touched only by the one load task running at a time, so unlocked
+    Stage<ParseKey, SVGParser::Document> parsed;
+    Stage<OutlineKey, std::vector<std::vector<Cubic>>> outline;
+    Stage<ResampleKey, std::vector<std::vector<glm::vec2>>> resampled;
+    Stage<TransformKey, std::vector<std::vector<Epicycle>>> transformed;
+};
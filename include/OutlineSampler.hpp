@@ -0,0 +1,327 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <glm/glm.hpp>
+
+#include "Bezier.hpp"
+#include "Parallel.hpp"
+#include "Simd.hpp"
+
+// --- Outline Sampler ---
+// Turns a stream of cubic segments into `count` points evenly spaced by
+// arc length along their adaptive flattening, centred and scaled so the
+// larger side spans `targetSize` (Y flipped for OpenGL).
+//
+// The flattened polyline is never stored. The source is walked three
+// times (bounds from control points, polyline length, then emission),
+// regenerating the same polyline on each walk, so the working set is the
+// output plus whatever the source itself holds.
+//
+// Sources are split into independent chunks (SVG paths, blocks of a
+// segment list) that are flattened in parallel. Each chunk's polyline runs
+// from its first segment's start to its last segment's end; consecutive
+// chunks are joined by a straight chord. Chunk lengths are combined by a
+// prefix sum, and each chunk then writes the samples that fall inside its
+// arc-length range straight into the output. The result depends only on
+// the chunking, never on the thread count.
+//
+// Every walk checks ThreadPool::Cancelled() between chunks and returns
+// no samples once the scope it runs in is cancelled.
+//
+// A source provides:
+//     size_t Chunks() const;
+//     template<typename Fn> void Segments(size_t chunk, Fn&& fn) const;  // fn(const Cubic&), in order
+class OutlineSampler {
+public:
+    template<typename Source>
+    static std::vector<glm::vec2> Sample(const Source& source, int count, float tolerance, float targetSize,
+                                         unsigned threads = 0) {
+        const size_t chunks = source.Chunks();
+        threads = Parallel::Resolve(threads);
+        if (chunks == 0 || count <= 0) return {};
+
+        // 1. Bounds from the control points (exact curve extrema)
+        std::vector<glm::dvec2> chunkMin(chunks, glm::dvec2(1e300)), chunkMax(chunks, glm::dvec2(-1e300));
+        Parallel::For(0, chunks, threads, 1, [&](size_t lo, size_t hi) {
+            for (size_t i = lo; i < hi && !ThreadPool::Cancelled(); ++i) {
+                source.Segments(i, [&](const Cubic& c) { c.ExpandBounds(chunkMin[i], chunkMax[i]); });
+            }
+        });
+        if (ThreadPool::Cancelled()) return {};
+        glm::dvec2 minB(1e300), maxB(-1e300);
+        for (size_t i = 0; i < chunks; ++i) {
+            minB = glm::min(minB, chunkMin[i]);
+            maxB = glm::max(maxB, chunkMax[i]);
+        }
+        if (minB.x > maxB.x) return {};
+
+        const double extent = std::max(maxB.x - minB.x, maxB.y - minB.y);
+        Frame frame;
+        frame.center = (minB + maxB) * 0.5;
+        frame.scale = targetSize / extent;
+        if (std::isnan(frame.scale) || std::isinf(frame.scale)) frame.scale = 1.0;
+        const double sourceTolerance = extent > 0.0 ? tolerance * extent / targetSize : 1.0;
+
+        return Walk(source, chunks, count, sourceTolerance, frame, threads);
+    }
+
+    // Sample for a source already in output units: no centring, scaling or
+    // flip, and `tolerance` applies as is. Used when several outlines share
+    // one normalization.
+    template<typename Source>
+    static std::vector<glm::vec2> Resample(const Source& source, int count, float tolerance, unsigned threads = 0) {
+        const size_t chunks = source.Chunks();
+        if (chunks == 0 || count <= 0) return {};
+        Frame identity;
+        identity.center = glm::dvec2(0.0);
+        identity.scale = 1.0;
+        identity.flip = false;
+        return Walk(source, chunks, count, tolerance, identity, Parallel::Resolve(threads));
+    }
+
+    // A segment list as a source, in fixed-size chunks.
+    struct CubicList {
+        static constexpr size_t CHUNK = 1024;
+        const std::vector<Cubic>& cubics;
+
+        size_t Chunks() const { return (cubics.size() + CHUNK - 1) / CHUNK; }
+
+        template<typename Fn>
+        void Segments(size_t chunk, Fn&& fn) const {
+            const size_t end = std::min(cubics.size(), (chunk + 1) * CHUNK);
+            for (size_t i = chunk * CHUNK; i < end; ++i) fn(cubics[i]);
+        }
+    };
+
+    // A list of subpaths as a source, drawn in list order. Subpaths longer
+    // than CHUNK cubics are split into several chunks.
+    struct SubpathList {
+        static constexpr size_t CHUNK = 1024;
+        const std::vector<std::vector<Cubic>>& subpaths;
+        std::vector<std::pair<size_t, size_t>> runs;  // (subpath, first cubic)
+
+        explicit SubpathList(const std::vector<std::vector<Cubic>>& list) : subpaths(list) {
+            for (size_t i = 0; i < subpaths.size(); ++i) {
+                for (size_t first = 0; first < subpaths[i].size(); first += CHUNK) runs.push_back({ i, first });
+            }
+        }
+
+        size_t Chunks() const { return runs.size(); }
+
+        template<typename Fn>
+        void Segments(size_t chunk, Fn&& fn) const {
+            const auto& sub = subpaths[runs[chunk].first];
+            const size_t end = std::min(sub.size(), runs[chunk].second + CHUNK);
+            for (size_t i = runs[chunk].second; i < end; ++i) fn(sub[i]);
+        }
+    };
+
+    // Stored flattening of a segment list (ghost outlines).
+    static std::vector<glm::vec2> Flatten(const std::vector<Cubic>& cubics, double tolerance) {
+        std::vector<glm::vec2> points;
+        CubicList source{cubics};
+        for (size_t i = 0; i < source.Chunks(); ++i) {
+            Polyline(source, i, tolerance, [&](glm::dvec2 p) { points.push_back(glm::vec2(p)); });
+        }
+        return points;
+    }
+
+    // The adaptive flattening of one chunk as (unstored) points: each cubic
+    // from u = 0 in FlattenSteps uniform steps, with a subpath's final
+    // endpoint added wherever the next segment does not continue from it
+    // and at the end of the chunk.
+    template<typename Source, typename Fn>
+    static void Polyline(const Source& source, size_t chunk, double tolerance, Fn&& emit) {
+        bool open = false;
+        glm::dvec2 end(0.0);
+        source.Segments(chunk, [&](const Cubic& c) {
+            if (open && c.p0 != end) emit(end);
+            CubicPoints(c, c.FlattenSteps(tolerance), emit);
+            end = c.p3;
+            open = true;
+        });
+        if (open) emit(end);
+    }
+
+    // c(i / steps) for i in [0, steps), evaluated BLOCK parameters at a time
+    // with the widest SIMD level available.
+    template<typename Fn>
+    static void CubicPoints(const Cubic& c, int steps, Fn&& emit) {
+        // Power basis: P(u) = ((a u + b) u + cc) u + d
+        const glm::dvec2 a = c.p3 - c.p0 + 3.0 * (c.p1 - c.p2);
+        const glm::dvec2 b = 3.0 * (c.p0 - 2.0 * c.p1 + c.p2);
+        const glm::dvec2 cc = 3.0 * (c.p1 - c.p0);
+        const double coeff[8] = { a.x, b.x, cc.x, c.p0.x, a.y, b.y, cc.y, c.p0.y };
+        const double du = 1.0 / steps;
+
+        alignas(Simd::ALIGNMENT) double xs[BLOCK], ys[BLOCK];
+        for (int i0 = 0; i0 < steps; i0 += BLOCK) {
+            EvaluateBlock(coeff, i0, du, xs, ys);
+            const int n = std::min(BLOCK, steps - i0);
+            for (int j = 0; j < n; ++j) emit(glm::dvec2(xs[j], ys[j]));
+        }
+    }
+
+private:
+    static constexpr int BLOCK = 16;
+    static constexpr size_t NO_NEXT = (size_t)-1;
+
+    struct Frame {
+        glm::dvec2 center;
+        double scale;
+        bool flip = true;  // Y up for OpenGL
+        glm::dvec2 operator()(glm::dvec2 p) const {
+            p = (p - center) * scale;
+            if (flip) p.y = -p.y;
+            return p;
+        }
+    };
+
+    struct ChunkStats {
+        size_t points = 0;
+        double length = 0.0;
+        glm::dvec2 first{0.0}, last{0.0};
+        double start = 0.0;      // arc length at `first`
+        double junction = 0.0;   // chord from `last` to the next chunk's first point
+        size_t next = NO_NEXT;   // next non-empty chunk
+    };
+
+    // Steps 2 and 3 of Sample: polyline lengths per chunk, then emission.
+    template<typename Source>
+    static std::vector<glm::vec2> Walk(const Source& source, size_t chunks, int count, double sourceTolerance,
+                                       const Frame& frame, unsigned threads) {
+        // 2. Per-chunk polyline length and end points
+        std::vector<ChunkStats> stats(chunks);
+        Parallel::For(0, chunks, threads, 1, [&](size_t lo, size_t hi) {
+            for (size_t i = lo; i < hi && !ThreadPool::Cancelled(); ++i) {
+                ChunkStats& st = stats[i];
+                glm::dvec2 prev(0.0);
+                Polyline(source, i, sourceTolerance, [&](glm::dvec2 p) {
+                    p = frame(p);
+                    if (st.points++ == 0) st.first = p;
+                    else st.length += glm::length(p - prev);
+                    prev = p;
+                });
+                st.last = prev;
+            }
+        });
+        if (ThreadPool::Cancelled()) return {};
+
+        // Prefix sum: arc-length start of every chunk, and the chord to the next
+        size_t points = 0;
+        double total = 0.0;
+        size_t lastChunk = chunks;
+        for (size_t i = 0; i < chunks; ++i) {
+            if (stats[i].points == 0) continue;
+            if (lastChunk != chunks) {
+                stats[lastChunk].next = i;
+                stats[lastChunk].junction = glm::length(stats[i].first - stats[lastChunk].last);
+                total += stats[lastChunk].junction;
+            }
+            stats[i].start = total;
+            total += stats[i].length;
+            points += stats[i].points;
+            lastChunk = i;
+        }
+
+        std::vector<glm::vec2> out;
+        if (points < 2) {
+            out.push_back(glm::vec2(stats[lastChunk].last));
+            return out;
+        }
+
+        // Sample k sits at k * step. A region [from, to) of the walk owns the
+        // samples from FirstSample(from) up to FirstSample(to).
+        const double step = total / count;
+        auto firstSample = [&](double position) {
+            long long k = (long long)std::ceil(position / step);
+            k = std::clamp<long long>(k, 0, count);
+            while (k > 0 && (double)(k - 1) * step >= position) --k;
+            while (k < count && (double)k * step < position) ++k;
+            return (int)k;
+        };
+
+        // 3. Walk each chunk again and write its samples
+        out.resize(count);
+        Parallel::For(0, chunks, threads, 1, [&](size_t lo, size_t hi) {
+            for (size_t i = lo; i < hi && !ThreadPool::Cancelled(); ++i) {
+                const ChunkStats& st = stats[i];
+                if (st.points == 0) continue;
+                const bool final = st.next == NO_NEXT;
+                const double end = st.start + st.length;
+                int k = firstSample(st.start);
+                const int kEnd = final ? count : firstSample(end);
+
+                glm::dvec2 prev(0.0);
+                double walked = 0.0;
+                size_t seen = 0;
+                Polyline(source, i, sourceTolerance, [&](glm::dvec2 p) {
+                    p = frame(p);
+                    if (seen++ == 0) {
+                        prev = p;
+                        return;
+                    }
+                    const double len = glm::length(p - prev);
+                    const double chordEnd = walked + len;
+                    while (k < kEnd && (double)k * step - st.start <= chordEnd) {
+                        const double t = len > 0.00001 ? ((double)k * step - st.start - walked) / len : 0.0;
+                        out[k++] = glm::vec2(glm::mix(prev, p, std::clamp(t, 0.0, 1.0)));
+                    }
+                    walked = chordEnd;
+                    prev = p;
+                });
+                while (k < kEnd) out[k++] = glm::vec2(st.last);  // rounding at the end of the chunk
+
+                // Chord to the next chunk
+                if (!final) {
+                    const glm::dvec2 target = stats[st.next].first;
+                    const int jEnd = firstSample(stats[st.next].start);
+                    for (; k < jEnd; ++k) {
+                        const double t = st.junction > 0.00001 ? ((double)k * step - end) / st.junction : 0.0;
+                        out[k] = glm::vec2(glm::mix(st.last, target, std::clamp(t, 0.0, 1.0)));
+                    }
+                }
+            }
+        });
+        if (ThreadPool::Cancelled()) return {};
+
+        return out;
+    }
+
+    static void EvaluateBlock(const double* coeff, int i0, double du, double* xs, double* ys) {
+#if FF_SIMD_X86
+        switch (Simd::Active()) {
+            case Simd::Level::AVX512: EvaluateAVX512(coeff, i0, du, xs, ys); return;
+            case Simd::Level::AVX2: EvaluateAVX2(coeff, i0, du, xs, ys); return;
+            default: break;
+        }
+#endif
+        EvaluateKernel<2>(coeff, i0, du, xs, ys);
+    }
+
+#if FF_SIMD_X86
+    FF_TARGET_AVX512 static void EvaluateAVX512(const double* coeff, int i0, double du, double* xs, double* ys) {
+        EvaluateKernel<8>(coeff, i0, du, xs, ys);
+    }
+    FF_TARGET_AVX2 static void EvaluateAVX2(const double* coeff, int i0, double du, double* xs, double* ys) {
+        EvaluateKernel<4>(coeff, i0, du, xs, ys);
+    }
+#endif
+
+    // Horner in u for W parameters per register.
+    template<int W>
+    FF_ALWAYS_INLINE static void EvaluateKernel(const double* coeff, int i0, double du, double* xs, double* ys) {
+        using V = typename Simd::VecD<W>::type;
+        V lane;
+        for (int j = 0; j < W; ++j) lane[j] = (double)j;
+        for (int j = 0; j < BLOCK; j += W) {
+            const V u = (lane + (double)(i0 + j)) * du;
+            const V x = ((coeff[0] * u + coeff[1]) * u + coeff[2]) * u + coeff[3];
+            const V y = ((coeff[4] * u + coeff[5]) * u + coeff[6]) * u + coeff[7];
+            *(V*)(xs + j) = x;
+            *(V*)(ys + j) = y;
+        }
+    }
+};
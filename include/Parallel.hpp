@@ -0,0 +1,61 @@
+#pragma once
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <algorithm>
+#include <cstddef>
+
+#include "ThreadPool.hpp"
+
+// --- Parallel Helpers ---
+// Fork/join over an index range. The range is cut into contiguous chunks
+// so callers that write disjoint outputs get results independent of the
+// thread count. Chunks run as ThreadPool tasks in the caller's lane; the
+// caller runs the first one and any that no worker has picked up yet.
+class Parallel {
+public:
+    // Worker count used when callers pass threads = 0.
+    static unsigned ThreadCount() {
+        unsigned n = configuredThreads().load();
+        if (n == 0) n = std::max(1u, std::thread::hardware_concurrency());
+        return n;
+    }
+
+    // 0 restores the default (one thread per hardware core).
+    static void SetThreadCount(unsigned n) { configuredThreads() = n; }
+
+    static unsigned Resolve(unsigned threads) {
+        return threads == 0 ? ThreadCount() : threads;
+    }
+
+    // Calls fn(lo, hi) for disjoint chunks covering [begin, end).
+    // Chunks smaller than minChunk are not split further.
+    template<typename Fn>
+    static void For(size_t begin, size_t end, unsigned threads, size_t minChunk, Fn&& fn) {
+        if (end <= begin) return;
+        size_t count = end - begin;
+        threads = Resolve(threads);
+
+        size_t maxChunks = std::max<size_t>(1, count / std::max<size_t>(1, minChunk));
+        size_t chunks = std::min<size_t>(threads, maxChunks);
+        if (chunks <= 1) {
+            fn(begin, end);
+            return;
+        }
+
+        ThreadPool::Group group;
+        for (size_t c = 1; c < chunks; ++c) {
+            size_t lo = begin + count * c / chunks;
+            size_t hi = begin + count * (c + 1) / chunks;
+            group.Run([&fn, lo, hi]() { fn(lo, hi); });
+        }
+        fn(begin, begin + count / chunks);
+        group.Wait();
+    }
+
+private:
+    static std::atomic<unsigned>& configuredThreads() {
+        static std::atomic<unsigned> n{0};
+        return n;
+    }
+};
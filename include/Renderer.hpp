@@ -185,9 +185,16 @@ public:
 
     void UpdateAndDraw(const std::vector<glm::vec2>& points, Shader& shader, glm::vec4 color) {
         if(points.empty()) return;
-        size_t count = std::min(points.size(), maxPoints);
+        size_t count = points.size();
 
         glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        // maxPoints is only the starting capacity. Adaptive and exact
+        // outlines can be much longer, so the buffer grows to fit rather
+        // than cutting the strip short.
+        if (count > maxPoints) {
+            maxPoints = std::max(count, maxPoints * 2);
+            glBufferData(GL_ARRAY_BUFFER, maxPoints * sizeof(glm::vec2), nullptr, GL_DYNAMIC_DRAW);
+        }
         glBufferSubData(GL_ARRAY_BUFFER, 0, count * sizeof(glm::vec2), points.data());
 
         shader.Use();
@@ -5,121 +5,388 @@
 #include <glm/glm.hpp>
 #include <algorithm>
 #include <cmath>
+#include <filesystem>
+#include <functional>
+#include <memory>
+
+#include "Bezier.hpp"
+#include "FFT.hpp"
+#include "OutlineSampler.hpp"
+#include "SVGStream.hpp"
+#include "SubpathOrder.hpp"
 
 #define NANOSVG_IMPLEMENTATION
 #include "nanosvg.h"
 
 class SVGParser {
 public:
-    static std::vector<glm::vec2> LoadAndSample(const std::string& filepath, int numSamples = 3000) {
-        std::cout << "Parsing SVG: " << filepath << std::endl;
-
-        NSVGimage* image = nsvgParseFromFile(filepath.c_str(), "px", 96);
-        if (!image) {
-            std::cerr << "Failed to open SVG file." << std::endl;
-            return {};
-        }
-
-        std::vector<glm::vec2> rawPoints;
-        rawPoints.reserve(10000); 
-
-        // 1. Extract Raw Bezier Samples
-        for (NSVGshape* shape = image->shapes; shape != NULL; shape = shape->next) {
-            for (NSVGpath* path = shape->paths; path != NULL; path = path->next) {
-                for (int i = 0; i < path->npts - 1; i += 3) {
-                    float* p = &path->pts[i * 2];
-                    // Sample bezier curves heavily to capture detail
-                    for (float t = 0; t < 1.0f; t += 0.05f) {
-                        float it = 1.0f - t;
-                        // Cubic Bezier Formula
-                        float x = it*it*it*p[0] + 3*it*it*t*p[2] + 3*it*t*t*p[4] + t*t*t*p[6];
-                        float y = it*it*it*p[1] + 3*it*it*t*p[3] + 3*it*t*t*p[5] + t*t*t*p[7];
-                        rawPoints.push_back(glm::vec2(x, y));
-                    }
-                }
+    // Loaded outlines are centred and scaled so the larger side spans this.
+    static constexpr float NORMALIZED_SIZE = 1000.0f;
+
+    // Front ends:
+    //   Full      nanosvg: every shape, CSS styles, paint servers and units
+    //             resolved, the whole file read into memory first.
+    //   Geometry  SVGStream: path data, basic shapes and transforms only,
+    //             tokenized straight out of a memory map. Much faster on
+    //             heavily styled files and flat in memory on huge ones.
+    //   Auto      Geometry for files of STREAMING_BYTES and up, else Full.
+    enum class ParseMode { Auto, Full, Geometry };
+
+    static constexpr uintmax_t STREAMING_BYTES = 64ull << 20;
+
+    // Sample counts of ADAPTIVE (or less) pick the count from the curve:
+    // starting at ADAPTIVE_MIN, the count doubles until the spectrum's top
+    // half (frequencies above N/4, up to Nyquist) carries less RMS distance
+    // than the flattening tolerance. A curve sampled that finely has
+    // nothing left to fold back from above Nyquist, so a plain icon stops
+    // at about a thousand samples while a dense map keeps doubling up to
+    // ADAPTIVE_MAX.
+    static constexpr int ADAPTIVE = 0;
+    static constexpr int ADAPTIVE_MIN = 256;
+    static constexpr int ADAPTIVE_MAX = 1 << 18;
+
+    class Document;
+
+    // Flattening is adaptive: each cubic gets just enough points to stay
+    // within `tolerance` of the true curve, measured in normalized units
+    // (the output spans NORMALIZED_SIZE). Extraction, normalization and
+    // arc-length resampling are fused in OutlineSampler, which streams
+    // the segments straight out of the parsed file, one path (or run of a
+    // long path) per parallel chunk; no intermediate point buffer is built.
+    // With `reorder`, subpaths are collected first and drawn in the order
+    // and direction SubpathOrder picks instead of document order.
+    static std::vector<glm::vec2> LoadAndSample(const std::string& filepath, int numSamples = 3000,
+                                                float tolerance = 0.1f, ParseMode mode = ParseMode::Auto,
+                                                bool reorder = false) {
+        const std::shared_ptr<const Document> document = Document::Open(filepath, mode);
+        if (!document) return {};
+        std::vector<glm::vec2> samples;
+        if (reorder) {
+            std::vector<std::vector<Cubic>> subpaths = Subpaths(*document);
+            Reorder(subpaths);
+            samples = SampleJoined(OutlineSampler::SubpathList{ subpaths }, numSamples, tolerance);
+        } else {
+            document->Visit([&](const auto& source) { samples = SampleJoined(source, numSamples, tolerance); });
+        }
+        if (samples.empty()) {
+            std::cerr << "No path data found in SVG." << std::endl;
+        } else if (numSamples <= ADAPTIVE) {
+            std::cout << "Adaptive sampling: " << samples.size() << " samples" << std::endl;
+        }
+        return samples;
+    }
+
+    // Sees every sampling pass and whether the search settled on it;
+    // returning false stops the search.
+    using PassHook = std::function<bool(const std::vector<glm::vec2>& points, bool final)>;
+
+    // One joined, normalized outline sampled straight from an
+    // OutlineSampler source: `numSamples` points, or with ADAPTIVE the
+    // search described above.
+    template<typename Source>
+    static std::vector<glm::vec2> SampleJoined(const Source& source, int numSamples, float tolerance,
+                                               const PassHook& observe = {}) {
+        return Adaptive(numSamples, tolerance, ADAPTIVE_MAX, [&](int count) {
+            return OutlineSampler::Sample(source, count, tolerance, NORMALIZED_SIZE);
+        }, observe);
+    }
+
+    // The segments of an OutlineSampler source end to end, in source
+    // units, as exact cubics with no sampling. Straight segments bridge the
+    // gaps between subpaths and close the loop, so the curve is continuous.
+    // Like Subpaths, this stops short once the calling scope is cancelled.
+    template<typename Source>
+    static std::vector<Cubic> Join(const Source& source) {
+        std::vector<Cubic> cubics;
+        for (size_t chunk = 0; chunk < source.Chunks() && !ThreadPool::Cancelled(); ++chunk) {
+            source.Segments(chunk, [&](const Cubic& c) {
+                if (!cubics.empty() && cubics.back().p3 != c.p0) cubics.push_back(Cubic::Line(cubics.back().p3, c.p0));
+                cubics.push_back(c);
+            });
+        }
+        if (!cubics.empty() && cubics.back().p3 != cubics.front().p0) {
+            cubics.push_back(Cubic::Line(cubics.back().p3, cubics.front().p0));
+        }
+        return cubics;
+    }
+
+    static std::vector<Cubic> Join(const std::vector<std::vector<Cubic>>& subpaths) {
+        return Join(OutlineSampler::SubpathList{ subpaths });
+    }
+
+    // Every subpath as its own list of cubics, in document order and
+    // source units. A new subpath starts wherever a segment does not begin
+    // at the end of the previous one.
+    static std::vector<std::vector<Cubic>> Subpaths(const Document& document) {
+        std::vector<std::vector<Cubic>> subpaths;
+        document.Visit([&](const auto& source) {
+            for (size_t chunk = 0; chunk < source.Chunks() && !ThreadPool::Cancelled(); ++chunk) {
+                source.Segments(chunk, [&](const Cubic& c) {
+                    if (subpaths.empty() || subpaths.back().back().p3 != c.p0) subpaths.emplace_back();
+                    subpaths.back().push_back(c);
+                });
+            }
+        });
+        return subpaths;
+    }
+
+    static std::vector<std::vector<Cubic>> LoadSubpaths(const std::string& filepath, ParseMode mode = ParseMode::Auto) {
+        const std::shared_ptr<const Document> document = Document::Open(filepath, mode);
+        return document ? Subpaths(*document) : std::vector<std::vector<Cubic>>{};
+    }
+
+    // Reorders and reverses subpaths to shorten the jumps a joined outline
+    // has to draw (see SubpathOrder), and logs the saving.
+    static SubpathOrder::Result Reorder(std::vector<std::vector<Cubic>>& subpaths) {
+        const SubpathOrder::Result result = SubpathOrder::Optimize(subpaths);
+        if (subpaths.size() > 1) {
+            std::cout << "Reordered " << subpaths.size() << " subpaths: jumps " << result.before << " -> "
+                      << result.after << " (source units)" << std::endl;
+        }
+        return result;
+    }
+
+    // The outline as separate signals instead of one joined loop: one part
+    // per subpath, so the jumps between disjoint subpaths never enter a
+    // spectrum. Past MAX_PARTS subpaths, consecutive ones are grouped into
+    // MAX_PARTS parts. An open part (a stroke that does not return to its
+    // start) is traced there and back, so its pen never jumps either.
+    // All parts share one normalization (NormalizeSubpaths), and
+    // SampleParts splits the sample count between them by length (at least
+    // MIN_PART_SAMPLES each). With ADAPTIVE, each part picks its own count,
+    // capped at its length share of ADAPTIVE_MAX.
+    static constexpr size_t MAX_PARTS = 64;
+    static constexpr int MIN_PART_SAMPLES = 64;
+
+    // Normalizes subpaths together: one frame over the exact bounds of all
+    // of them, as OutlineSampler::Sample uses for a single outline.
+    static void NormalizeSubpaths(std::vector<std::vector<Cubic>>& subpaths, float targetSize = NORMALIZED_SIZE) {
+        glm::dvec2 minB(1e300), maxB(-1e300);
+        for (const auto& sub : subpaths) {
+            for (const auto& c : sub) c.ExpandBounds(minB, maxB);
+        }
+        const glm::dvec2 center = (minB + maxB) * 0.5;
+        double scale = targetSize / std::max(maxB.x - minB.x, maxB.y - minB.y);
+        if (std::isnan(scale) || std::isinf(scale)) scale = 1.0;
+        for (auto& sub : subpaths) Transform(sub, center, scale);
+    }
+
+    // Groups subpaths into at most MAX_PARTS parts, tracing open parts
+    // there and back.
+    static std::vector<std::vector<Cubic>> SplitParts(std::vector<std::vector<Cubic>> subpaths) {
+        std::vector<std::vector<Cubic>> parts;
+        const size_t groups = std::min(subpaths.size(), MAX_PARTS);
+        for (size_t g = 0; g < groups; ++g) {
+            std::vector<Cubic> part;
+            for (size_t i = g * subpaths.size() / groups; i < (g + 1) * subpaths.size() / groups; ++i) {
+                part.insert(part.end(), subpaths[i].begin(), subpaths[i].end());
+            }
+            double length = 0.0;
+            for (const auto& c : part) length += c.Length();
+            const double gap = glm::length(part.back().p3 - part.front().p0);
+            if (gap > OPEN_GAP * length) {
+                for (size_t j = part.size(); j-- > 0;) part.push_back({ part[j].p3, part[j].p2, part[j].p1, part[j].p0 });
             }
+            parts.push_back(std::move(part));
         }
-        
-        nsvgDelete(image);
+        return parts;
+    }
+
+    // Called after every sampling pass with the part's index in the result,
+    // its points, and whether the search settled on them. Returning false
+    // stops sampling; the result is then incomplete.
+    using SampleHook = std::function<bool(size_t part, const std::vector<glm::vec2>& points, bool final)>;
 
-        if (rawPoints.empty()) {
-             std::cerr << "No path data found in SVG." << std::endl;
-             return {};
+    // Samples already normalized parts, splitting `numSamples` by length
+    // (or ADAPTIVE per part). Parts of zero length are dropped.
+    static std::vector<std::vector<glm::vec2>> SampleParts(const std::vector<std::vector<Cubic>>& parts, int numSamples,
+                                                           float tolerance, const SampleHook& hook = {}) {
+        std::vector<double> lengths(parts.size(), 0.0);
+        double total = 0.0;
+        for (size_t i = 0; i < parts.size(); ++i) {
+            for (const auto& c : parts[i]) lengths[i] += c.Length();
+            total += lengths[i];
         }
 
-        // 2. Normalize Raw Points BEFORE Resampling
-        // This fixes issues with tiny or huge SVGs
-        NormalizeInPlace(rawPoints, 1000.0f);
+        std::vector<std::vector<glm::vec2>> samples;
+        for (size_t i = 0; i < parts.size(); ++i) {
+            if (lengths[i] <= 0.0) continue;
+            const double share = lengths[i] / total;
+            const int count = numSamples <= ADAPTIVE
+                                  ? ADAPTIVE
+                                  : std::max(MIN_PART_SAMPLES, (int)std::lround(numSamples * share));
+            const int maxCount = std::max(ADAPTIVE_MIN, (int)(ADAPTIVE_MAX * share));
+            const size_t index = samples.size();
+            bool stopped = false;
+            samples.push_back(Adaptive(
+                count, tolerance, maxCount,
+                [&](int n) { return OutlineSampler::Resample(OutlineSampler::CubicList{ parts[i] }, n, tolerance); },
+                [&](const std::vector<glm::vec2>& points, bool final) {
+                    stopped = hook && !hook(index, points, final);
+                    return !stopped;
+                }));
+            if (stopped) break;
+        }
+        return samples;
+    }
 
-        // 3. Resample to fixed count (Uniform Arc Length)
-        return ResampleByLength(rawPoints, numSamples);
+    // Parses `filepath` with the front end `mode` selects and calls
+    // fn(source) with an OutlineSampler source over its segments. Returns
+    // false (after logging) if the file could not be read.
+    template<typename Fn>
+    static bool WithSource(const std::string& filepath, ParseMode mode, Fn&& fn) {
+        const std::shared_ptr<const Document> document = Document::Open(filepath, mode);
+        if (!document) return false;
+        document->Visit(fn);
+        return true;
     }
 
 private:
-    static void NormalizeInPlace(std::vector<glm::vec2>& points, float targetSize) {
-        if (points.empty()) return;
-        
-        glm::vec2 minB(1e9), maxB(-1e9);
-        for(const auto& p : points) {
-            minB = glm::min(minB, p);
-            maxB = glm::max(maxB, p);
-        }
-
-        glm::vec2 center = (minB + maxB) * 0.5f;
-        float w = maxB.x - minB.x;
-        float h = maxB.y - minB.y;
-        float scale = targetSize / std::max(w, h);
-        if (std::isnan(scale) || std::isinf(scale)) scale = 1.0f;
-
-        for(auto& p : points) {
+    // sample(count) for a fixed count, or the adaptive search above,
+    // stopping once the count reaches maxCount. observe(points, final), if
+    // given, sees every pass and may stop the search by returning false.
+    template<typename SampleFn>
+    static std::vector<glm::vec2> Adaptive(int count, float tolerance, int maxCount, SampleFn&& sample,
+                                           const PassHook& observe = {}) {
+        if (count > ADAPTIVE) {
+            std::vector<glm::vec2> points = sample(count);
+            if (observe) observe(points, true);
+            return points;
+        }
+        for (int n = ADAPTIVE_MIN;; n *= 2) {
+            std::vector<glm::vec2> points = sample(n);
+            const bool final = points.empty() || n >= maxCount || HighBandRMS(points) <= tolerance;
+            if ((observe && !observe(points, final)) || final) return points;
+        }
+    }
+
+    // RMS distance carried by frequencies above N/4, the top half of the
+    // representable band. A joined outline that does not end where it
+    // starts jumps back on wrap-around, and that jump's 1/k tail never
+    // shrinks with N, so it is taken out first: a ramp spread over the
+    // samples closes the gap.
+    static double HighBandRMS(const std::vector<glm::vec2>& points) {
+        const size_t N = points.size();
+        if (N < 4) return 0.0;
+        const glm::dvec2 gap = glm::dvec2(points.front()) - glm::dvec2(points.back());
+        std::vector<std::complex<double>> signal(N), spectrum(N);
+        for (size_t n = 0; n < N; ++n) {
+            const glm::dvec2 p = glm::dvec2(points[n]) + gap * ((double)n / (double)(N - 1));
+            signal[n] = std::complex<double>(p.x, p.y);
+        }
+        FFTPlan::Get(N)->Forward(signal.data(), spectrum.data(), Parallel::ThreadCount());
+
+        double energy = 0.0;
+        for (size_t k = N / 4 + 1; k < N - N / 4; ++k) energy += std::norm(spectrum[k]);
+        return std::sqrt(energy) / (double)N;
+    }
+
+    // A part whose ends are further apart than this fraction of its length
+    // is treated as open.
+    static constexpr double OPEN_GAP = 0.01;
+
+    static void Transform(std::vector<Cubic>& cubics, glm::dvec2 center, double scale) {
+        auto transform = [&](glm::dvec2 p) {
             p = (p - center) * scale;
-            p.y *= -1.0f; // Flip Y for OpenGL
+            p.y = -p.y;
+            return p;
+        };
+        for (auto& c : cubics) {
+            c = { transform(c.p0), transform(c.p1), transform(c.p2), transform(c.p3) };
         }
     }
 
-    static std::vector<glm::vec2> ResampleByLength(const std::vector<glm::vec2>& raw, int count) {
-        if (raw.size() < 2) return raw;
+    // Parsed paths in document order as an OutlineSampler source. Long
+    // paths (map outlines, traced scans) are split into runs of at most
+    // CHUNK cubics so a single huge path still spreads across threads.
+    struct PathList {
+        static constexpr int CHUNK = 1024;
 
-        float totalLength = 0.0f;
-        std::vector<float> cumulativeLength;
-        cumulativeLength.reserve(raw.size());
-        cumulativeLength.push_back(0.0f);
+        struct Run {
+            const NSVGpath* path;
+            int first, end;  // cubic indices [first, end)
+        };
+        std::vector<Run> runs;
 
-        for (size_t i = 0; i < raw.size() - 1; ++i) {
-            float dist = glm::distance(raw[i], raw[i+1]);
-            totalLength += dist;
-            cumulativeLength.push_back(totalLength);
+        void Add(const NSVGpath* path) {
+            const int cubics = (path->npts - 1) / 3;
+            for (int first = 0; first < cubics; first += CHUNK) {
+                runs.push_back({ path, first, std::min(cubics, first + CHUNK) });
+            }
         }
 
-        std::vector<glm::vec2> resampled;
-        resampled.reserve(count);
+        size_t Chunks() const { return runs.size(); }
 
-        float step = totalLength / count;
-        float currentDist = 0.0f;
-        
-        size_t rawIndex = 0;
-        for (int i = 0; i < count; ++i) {
-            // Find segment
-            while (rawIndex < cumulativeLength.size() - 1 && cumulativeLength[rawIndex+1] < currentDist) {
-                rawIndex++;
+        template<typename Fn>
+        void Segments(size_t chunk, Fn&& fn) const {
+            const Run& run = runs[chunk];
+            for (int i = run.first; i < run.end; ++i) {
+                const float* p = &run.path->pts[i * 6];
+                fn(Cubic{ glm::dvec2(p[0], p[1]), glm::dvec2(p[2], p[3]),
+                          glm::dvec2(p[4], p[5]), glm::dvec2(p[6], p[7]) });
             }
+        }
+    };
 
-            if (rawIndex >= raw.size() - 1) {
-                resampled.push_back(raw.back());
-            } else {
-                float segmentStart = cumulativeLength[rawIndex];
-                float segmentEnd = cumulativeLength[rawIndex+1];
-                float segmentLen = segmentEnd - segmentStart;
-                
-                float t = 0.0f;
-                if (segmentLen > 0.00001f) {
-                    t = (currentDist - segmentStart) / segmentLen;
+public:
+    // --- Parsed Document ---
+    // A parsed file kept open so it can be walked again without parsing it
+    // again: the SVGStream run index over its memory map, or the nanosvg
+    // image. Either costs little next to the cubics it expands to, so a
+    // load keeps this between runs instead of a copy of every segment.
+    class Document {
+    public:
+        Document() = default;
+        ~Document() {
+            if (image) nsvgDelete(image);
+        }
+        Document(const Document&) = delete;
+        Document& operator=(const Document&) = delete;
+
+        // Null (after logging) if the file could not be read.
+        static std::shared_ptr<const Document> Open(const std::string& filepath, ParseMode mode) {
+            if (mode == ParseMode::Auto) {
+                std::error_code ec;
+                const uintmax_t bytes = std::filesystem::file_size(filepath, ec);
+                mode = !ec && bytes >= STREAMING_BYTES ? ParseMode::Geometry : ParseMode::Full;
+            }
+
+            auto document = std::make_shared<Document>();
+            if (mode == ParseMode::Geometry) {
+                if (!document->stream.Open(filepath)) {
+                    std::cerr << "Failed to open SVG file." << std::endl;
+                    return nullptr;
                 }
-                resampled.push_back(glm::mix(raw[rawIndex], raw[rawIndex+1], t));
+                std::cout << "Parsing SVG geometry: " << filepath << " (" << document->stream.Bytes() / 1024
+                          << " KB, " << document->stream.Elements() << " elements)" << std::endl;
+                return document;
             }
-            currentDist += step;
+
+            std::cout << "Parsing SVG: " << filepath << std::endl;
+            document->image = nsvgParseFromFile(filepath.c_str(), "px", 96);
+            if (!document->image) {
+                std::cerr << "Failed to open SVG file." << std::endl;
+                return nullptr;
+            }
+            for (NSVGshape* shape = document->image->shapes; shape != NULL; shape = shape->next) {
+                for (NSVGpath* path = shape->paths; path != NULL; path = path->next) document->paths.Add(path);
+            }
+            return document;
         }
 
-        return resampled;
-    }
-};
\ No newline at end of file
+        // fn(source) with an OutlineSampler source over the segments.
+        template<typename Fn>
+        void Visit(Fn&& fn) const {
+            if (image) {
+                fn(paths);
+            } else {
+                fn(stream);
+            }
+        }
+
+    private:
+        SVGStream stream;
+        NSVGimage* image = nullptr;
+        PathList paths;
+    };
+};
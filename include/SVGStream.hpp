@@ -0,0 +1,637 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <string_view>
+#include <cstring>
+#include <cmath>
+#include <charconv>
+#include <cstdint>
+#include <algorithm>
+#include <glm/glm.hpp>
+
+#if defined(_WIN32)
+#include <fstream>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "Bezier.hpp"
+#include "ThreadPool.hpp"
+
+// --- Mapped File ---
+// Read-only view of a whole file. Pages are faulted in on access and stay
+// clean, file-backed memory the kernel can drop again, so files larger
+// than RAM can be walked without growing the heap.
+class MappedFile {
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile() { Close(); }
+
+    bool Open(const std::string& path) {
+        Close();
+#if defined(_WIN32)
+        std::ifstream in(path, std::ios::binary | std::ios::ate);
+        if (!in) return false;
+        buffer.resize((size_t)in.tellg());
+        in.seekg(0);
+        in.read(buffer.data(), (std::streamsize)buffer.size());
+        bytes = buffer.data();
+        length = buffer.size();
+        return (bool)in;
+#else
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            return false;
+        }
+        if (st.st_size > 0) {
+            void* p = ::mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED) {
+                ::close(fd);
+                return false;
+            }
+            ::madvise(p, (size_t)st.st_size, MADV_SEQUENTIAL);
+            bytes = (const char*)p;
+            length = (size_t)st.st_size;
+        }
+        ::close(fd);
+        return true;
+#endif
+    }
+
+    void Close() {
+#if !defined(_WIN32)
+        if (length > 0) ::munmap((void*)bytes, length);
+#else
+        buffer.clear();
+#endif
+        bytes = nullptr;
+        length = 0;
+    }
+
+    const char* Data() const { return bytes; }
+    size_t Size() const { return length; }
+
+    // 64-bit content hash of the mapped bytes (not cryptographic).
+    uint64_t Hash() const { return Hash(bytes, length); }
+
+    // One multiply-xorshift round per 8-byte word, then a final avalanche.
+    static uint64_t Hash(const char* data, size_t size) {
+        uint64_t h = 0x9E3779B97F4A7C15ull ^ (uint64_t)size;
+        size_t i = 0;
+        for (; i + 8 <= size; i += 8) {
+            uint64_t w;
+            std::memcpy(&w, data + i, 8);
+            h = (h ^ w) * 0xFF51AFD7ED558CCDull;
+            h ^= h >> 32;
+        }
+        uint64_t tail = 0;
+        if (i < size) std::memcpy(&tail, data + i, size - i);
+        h = (h ^ tail) * 0xC4CEB9FE1A85EC53ull;
+        h ^= h >> 33;
+        h *= 0xFF51AFD7ED558CCDull;
+        return h ^ (h >> 33);
+    }
+
+private:
+    const char* bytes = nullptr;
+    size_t length = 0;
+#if defined(_WIN32)
+    std::vector<char> buffer;
+#endif
+};
+
+// --- SVG Path Data ---
+// Tokenizer for the `d` attribute grammar. Every drawing command is emitted
+// as cubics in user units: lines and quadratics exactly, elliptical arcs as
+// one cubic per quarter turn at most. Closepath adds the closing line.
+// Parsing stops at the first malformed token, as SVG renderers do.
+class PathData {
+public:
+    template<typename Fn>
+    static void Parse(const char* p, const char* end, Fn&& fn) {
+        glm::dvec2 cur(0.0), start(0.0), ctrl(0.0);
+        char cmd = 0, prev = 0;
+        double a[7];
+
+        while (true) {
+            SkipSeparators(p, end);
+            if (p >= end) return;
+            if (IsCommand(*p)) {
+                cmd = *p++;
+            } else if (cmd == 0 || cmd == 'Z' || cmd == 'z') {
+                return;  // numbers with no command to repeat
+            }
+
+            const bool rel = cmd >= 'a';
+            const glm::dvec2 base = rel ? cur : glm::dvec2(0.0);
+            switch (cmd) {
+                case 'Z': case 'z':
+                    if (cur != start) fn(Cubic::Line(cur, start));
+                    cur = start;
+                    break;
+                case 'M': case 'm':
+                    if (!Numbers(p, end, a, 2)) return;
+                    cur = start = base + glm::dvec2(a[0], a[1]);
+                    cmd = rel ? 'l' : 'L';  // further pairs are lines
+                    break;
+                case 'L': case 'l':
+                    if (!Numbers(p, end, a, 2)) return;
+                    LineTo(cur, base + glm::dvec2(a[0], a[1]), fn);
+                    break;
+                case 'H': case 'h':
+                    if (!Numbers(p, end, a, 1)) return;
+                    LineTo(cur, glm::dvec2(base.x + a[0], cur.y), fn);
+                    break;
+                case 'V': case 'v':
+                    if (!Numbers(p, end, a, 1)) return;
+                    LineTo(cur, glm::dvec2(cur.x, base.y + a[0]), fn);
+                    break;
+                case 'C': case 'c': case 'S': case 's': {
+                    const bool smooth = cmd == 'S' || cmd == 's';
+                    if (!(smooth ? Numbers(p, end, a + 2, 4) : Numbers(p, end, a, 6))) return;
+                    const glm::dvec2 c1 = smooth ? (IsCubic(prev) ? 2.0 * cur - ctrl : cur) : base + glm::dvec2(a[0], a[1]);
+                    const glm::dvec2 c2 = base + glm::dvec2(a[2], a[3]);
+                    const glm::dvec2 p3 = base + glm::dvec2(a[4], a[5]);
+                    fn(Cubic{ cur, c1, c2, p3 });
+                    ctrl = c2;
+                    cur = p3;
+                    break;
+                }
+                case 'Q': case 'q': case 'T': case 't': {
+                    const bool smooth = cmd == 'T' || cmd == 't';
+                    if (!(smooth ? Numbers(p, end, a + 2, 2) : Numbers(p, end, a, 4))) return;
+                    const glm::dvec2 c = smooth ? (IsQuad(prev) ? 2.0 * cur - ctrl : cur) : base + glm::dvec2(a[0], a[1]);
+                    const glm::dvec2 p2 = base + glm::dvec2(a[2], a[3]);
+                    fn(Cubic{ cur, cur + (c - cur) * (2.0 / 3.0), p2 + (c - p2) * (2.0 / 3.0), p2 });
+                    ctrl = c;
+                    cur = p2;
+                    break;
+                }
+                case 'A': case 'a': {
+                    bool large = false, sweep = false;
+                    if (!Numbers(p, end, a, 3) || !Flag(p, end, large) || !Flag(p, end, sweep) ||
+                        !Numbers(p, end, a + 3, 2)) return;
+                    const glm::dvec2 target = base + glm::dvec2(a[3], a[4]);
+                    Arc(cur, a[0], a[1], a[2], large, sweep, target, fn);
+                    cur = target;
+                    break;
+                }
+                default:
+                    return;
+            }
+            prev = cmd;
+        }
+    }
+
+    // Reads `count` numbers (separated by whitespace and/or commas).
+    static bool Numbers(const char*& p, const char* end, double* out, int count) {
+        for (int i = 0; i < count; ++i) {
+            SkipSeparators(p, end);
+            const char* s = p < end && *p == '+' ? p + 1 : p;
+            auto result = std::from_chars(s, end, out[i]);
+            if (result.ec != std::errc()) return false;
+            p = result.ptr;
+        }
+        return true;
+    }
+
+    static void SkipSeparators(const char*& p, const char* end) {
+        while (p < end && (*p == ' ' || *p == ',' || *p == '\t' || *p == '\n' || *p == '\r' || *p == '\f')) ++p;
+    }
+
+private:
+    static bool IsCommand(char c) { return c != 0 && std::strchr("MmLlHhVvCcSsQqTtAaZz", c) != nullptr; }
+    static bool IsCubic(char c) { return c == 'C' || c == 'c' || c == 'S' || c == 's'; }
+    static bool IsQuad(char c) { return c == 'Q' || c == 'q' || c == 'T' || c == 't'; }
+
+    // Arc flags are single digits and may run into the next number ("a1 1 0 011 1").
+    static bool Flag(const char*& p, const char* end, bool& out) {
+        SkipSeparators(p, end);
+        if (p >= end || (*p != '0' && *p != '1')) return false;
+        out = *p++ == '1';
+        return true;
+    }
+
+    template<typename Fn>
+    static void LineTo(glm::dvec2& cur, glm::dvec2 target, Fn&& fn) {
+        fn(Cubic::Line(cur, target));
+        cur = target;
+    }
+
+    // Endpoint to centre parameterization (SVG 1.1, appendix F.6.5), then
+    // one cubic per span of at most 90 degrees.
+    template<typename Fn>
+    static void Arc(glm::dvec2 p0, double rx, double ry, double degrees, bool large, bool sweep, glm::dvec2 p1,
+                    Fn&& fn) {
+        if (p0 == p1) return;
+        rx = std::abs(rx);
+        ry = std::abs(ry);
+        if (rx == 0.0 || ry == 0.0) {
+            fn(Cubic::Line(p0, p1));
+            return;
+        }
+
+        const double phi = degrees * M_PI / 180.0, cs = std::cos(phi), sn = std::sin(phi);
+        const glm::dvec2 h = (p0 - p1) * 0.5;
+        const double x1 = cs * h.x + sn * h.y, y1 = -sn * h.x + cs * h.y;
+        const double lambda = (x1 * x1) / (rx * rx) + (y1 * y1) / (ry * ry);
+        if (lambda > 1.0) {
+            rx *= std::sqrt(lambda);
+            ry *= std::sqrt(lambda);
+        }
+
+        const double num = rx * rx * ry * ry - rx * rx * y1 * y1 - ry * ry * x1 * x1;
+        const double den = rx * rx * y1 * y1 + ry * ry * x1 * x1;
+        const double coef = (large == sweep ? -1.0 : 1.0) * std::sqrt(std::max(0.0, num / den));
+        const double cx1 = coef * rx * y1 / ry, cy1 = -coef * ry * x1 / rx;
+        const glm::dvec2 center(cs * cx1 - sn * cy1 + 0.5 * (p0.x + p1.x), sn * cx1 + cs * cy1 + 0.5 * (p0.y + p1.y));
+
+        const glm::dvec2 u((x1 - cx1) / rx, (y1 - cy1) / ry), v((-x1 - cx1) / rx, (-y1 - cy1) / ry);
+        const double theta = std::atan2(u.y, u.x);
+        double delta = std::atan2(u.x * v.y - u.y * v.x, glm::dot(u, v));
+        if (!sweep && delta > 0.0) delta -= 2.0 * M_PI;
+        if (sweep && delta < 0.0) delta += 2.0 * M_PI;
+
+        const int spans = std::max(1, (int)std::ceil(std::abs(delta) / (0.5 * M_PI) - 1e-9));
+        const double step = delta / spans;
+        const double k = 4.0 / 3.0 * std::tan(step / 4.0);
+        auto point = [&](double t) {
+            const double x = rx * std::cos(t), y = ry * std::sin(t);
+            return center + glm::dvec2(cs * x - sn * y, sn * x + cs * y);
+        };
+        auto tangent = [&](double t) {
+            const double x = -rx * std::sin(t), y = ry * std::cos(t);
+            return glm::dvec2(cs * x - sn * y, sn * x + cs * y);
+        };
+
+        glm::dvec2 from = p0;
+        for (int i = 0; i < spans; ++i) {
+            const double t0 = theta + i * step, t1 = t0 + step;
+            const glm::dvec2 to = i + 1 == spans ? p1 : point(t1);
+            fn(Cubic{ from, from + k * tangent(t0), to - k * tangent(t1), to });
+            from = to;
+        }
+    }
+};
+
+
+// --- 2D Affine Transform ---
+// SVG matrix(a b c d e f): x' = a x + c y + e, y' = b x + d y + f.
+struct Affine {
+    double a = 1.0, b = 0.0, c = 0.0, d = 1.0, e = 0.0, f = 0.0;
+
+    glm::dvec2 operator()(glm::dvec2 p) const { return { a * p.x + c * p.y + e, b * p.x + d * p.y + f }; }
+
+    // Beziers are affine invariant: transforming the control points is exact.
+    Cubic operator()(const Cubic& k) const { return { (*this)(k.p0), (*this)(k.p1), (*this)(k.p2), (*this)(k.p3) }; }
+
+    // this * o: apply o first.
+    Affine operator*(const Affine& o) const {
+        return { a * o.a + c * o.b, b * o.a + d * o.b, a * o.c + c * o.d, b * o.c + d * o.d,
+                 a * o.e + c * o.f + e, b * o.e + d * o.f + f };
+    }
+
+    // A `transform` attribute: a list of matrix, translate, scale, rotate,
+    // skewX and skewY applied right to left. Stops at the first malformed
+    // entry, keeping the ones before it.
+    static Affine Parse(const char* p, const char* end) {
+        Affine result;
+        while (true) {
+            PathData::SkipSeparators(p, end);
+            const char* name = p;
+            while (p < end && ((*p >= 'a' && *p <= 'z') || (*p >= 'A' && *p <= 'Z'))) ++p;
+            const std::string_view op(name, p - name);
+            PathData::SkipSeparators(p, end);
+            if (op.empty() || p >= end || *p != '(') return result;
+            ++p;
+
+            double v[6] = {};
+            int n = 0;
+            while (true) {
+                PathData::SkipSeparators(p, end);
+                if (p < end && *p == ')') { ++p; break; }
+                if (n == 6 || !PathData::Numbers(p, end, v + n, 1)) return result;
+                ++n;
+            }
+
+            Affine t;
+            if (op == "matrix" && n == 6) {
+                t = { v[0], v[1], v[2], v[3], v[4], v[5] };
+            } else if (op == "translate" && n >= 1) {
+                t.e = v[0];
+                t.f = n > 1 ? v[1] : 0.0;
+            } else if (op == "scale" && n >= 1) {
+                t.a = v[0];
+                t.d = n > 1 ? v[1] : v[0];
+            } else if (op == "rotate" && n >= 1) {
+                const double r = v[0] * M_PI / 180.0;
+                t = { std::cos(r), std::sin(r), -std::sin(r), std::cos(r), 0.0, 0.0 };
+                if (n == 3) t = Affine{ 1, 0, 0, 1, v[1], v[2] } * t * Affine{ 1, 0, 0, 1, -v[1], -v[2] };
+            } else if (op == "skewX" && n == 1) {
+                t.c = std::tan(v[0] * M_PI / 180.0);
+            } else if (op == "skewY" && n == 1) {
+                t.b = std::tan(v[0] * M_PI / 180.0);
+            } else {
+                return result;
+            }
+            result = result * t;
+        }
+    }
+};
+
+// --- Streaming SVG Source ---
+// Geometry-only SVG reader. The file is memory-mapped and indexed with a
+// single byte scan that records, for every drawn element, where its
+// geometry lives and which accumulated transform applies; no DOM, CSS,
+// gradient or paint state is built. The index (a few bytes per element
+// plus one matrix per transform attribute) is the only heap allocation.
+// Segments are tokenized straight out of the mapping each time the
+// sampler walks a chunk, so this is an OutlineSampler source with a
+// bounded working set.
+//
+// Reads <path>, <rect>, <circle>, <ellipse>, <line>, <polyline> and
+// <polygon> with their own and their ancestors' transforms, in user units
+// (the root viewBox is ignored: outlines are normalized afterwards, and
+// length units on shape attributes are dropped). Content of <defs>,
+// <clipPath>, <mask>, <symbol>, <marker> and <pattern> is skipped, as
+// nanosvg does.
+class SVGStream {
+public:
+    // Long path data is split into independently parsed runs at absolute
+    // moveto commands, where no parser state carries over.
+    static constexpr size_t RUN_BYTES = 64 * 1024;
+
+    bool Open(const std::string& path) {
+        runs.clear();
+        transforms.assign(1, Affine{});
+        elements = 0;
+        if (!file.Open(path)) return false;
+        Scan();
+        return true;
+    }
+
+    size_t Elements() const { return elements; }
+    size_t Bytes() const { return file.Size(); }
+
+    size_t Chunks() const { return runs.size(); }
+
+    template<typename Fn>
+    void Segments(size_t chunk, Fn&& fn) const {
+        const Run& run = runs[chunk];
+        if (run.transform == 0) {
+            Emit(run, fn);
+        } else {
+            const Affine& m = transforms[run.transform];
+            Emit(run, [&](const Cubic& c) { fn(m(c)); });
+        }
+    }
+
+private:
+    enum class Kind : uint8_t { Path, Rect, Circle, Ellipse, Line, Polyline, Polygon };
+
+    struct Run {
+        size_t begin, end;   // path data, or the element's attributes for basic shapes
+        uint32_t transform;  // index into transforms
+        Kind kind;
+    };
+
+    static constexpr size_t CANCEL_CHECK_TAGS = 4096;
+
+    // 4/3 (sqrt(2) - 1): control arm of a quarter circle
+    static constexpr double KAPPA = 0.5522847498307936;
+
+    MappedFile file;
+    std::vector<Run> runs;
+    std::vector<Affine> transforms;
+    size_t elements = 0;
+
+    static bool IsNameChar(char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+               c == ':' || c == '_' || c == '-' || c == '.';
+    }
+
+    static bool IsSpace(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
+    static bool IsHiddenContainer(std::string_view name) {
+        return name == "defs" || name == "clipPath" || name == "mask" || name == "symbol" ||
+               name == "marker" || name == "pattern";
+    }
+
+    static bool ShapeKind(std::string_view name, Kind& kind) {
+        if (name == "path") kind = Kind::Path;
+        else if (name == "rect") kind = Kind::Rect;
+        else if (name == "circle") kind = Kind::Circle;
+        else if (name == "ellipse") kind = Kind::Ellipse;
+        else if (name == "line") kind = Kind::Line;
+        else if (name == "polyline") kind = Kind::Polyline;
+        else if (name == "polygon") kind = Kind::Polygon;
+        else return false;
+        return true;
+    }
+
+    static const char* Find(const char* p, const char* end, std::string_view what) {
+        const char* hit = std::search(p, end, what.begin(), what.end());
+        return hit == end ? end : hit + what.size();
+    }
+
+    // Calls fn(name, valueBegin, valueEnd) for every quoted attribute from p
+    // (just past the element name) and returns the tag's closing '>', or end.
+    template<typename Fn>
+    static const char* Attributes(const char* p, const char* end, Fn&& fn) {
+        while (p < end) {
+            while (p < end && IsSpace(*p)) ++p;
+            if (p >= end || *p == '>') return p;
+            if (!IsNameChar(*p)) { ++p; continue; }
+
+            const char* name = p;
+            while (p < end && IsNameChar(*p)) ++p;
+            const std::string_view attr(name, p - name);
+            while (p < end && IsSpace(*p)) ++p;
+            if (p >= end || *p != '=') continue;
+            ++p;
+            while (p < end && IsSpace(*p)) ++p;
+            if (p >= end || (*p != '"' && *p != '\'')) continue;
+
+            const char* close = (const char*)std::memchr(p + 1, *p, end - p - 1);
+            if (!close) return end;
+            fn(attr, p + 1, close);
+            p = close + 1;
+        }
+        return end;
+    }
+
+    void Scan() {
+        const char* data = file.Data();
+        const char* end = data + file.Size();
+        const char* p = data;
+        int hiddenDepth = 0;
+        std::vector<uint32_t> stack{ 0 };  // transform of each open element
+        size_t tags = 0;
+
+        while (p < end && (p = (const char*)std::memchr(p, '<', end - p)) != nullptr) {
+            // A cancelled load discards the index, so stopping short is fine
+            if (++tags % CANCEL_CHECK_TAGS == 0 && ThreadPool::Cancelled()) return;
+            const std::string_view rest(p, end - p);
+            if (rest.substr(0, 4) == "<!--") { p = Find(p, end, "-->"); continue; }
+            if (rest.substr(0, 9) == "<![CDATA[") { p = Find(p, end, "]]>"); continue; }
+            if (rest.size() > 1 && (rest[1] == '?' || rest[1] == '!')) { p = Find(p, end, ">"); continue; }
+
+            const bool closing = rest.size() > 1 && rest[1] == '/';
+            const char* name = p + (closing ? 2 : 1);
+            const char* nameEnd = name;
+            while (nameEnd < end && IsNameChar(*nameEnd)) ++nameEnd;
+            const std::string_view tag(name, nameEnd - name);
+
+            const char* d = nullptr;
+            const char* dEnd = nullptr;
+            const char* transform = nullptr;
+            const char* transformEnd = nullptr;
+            const char* close = Attributes(nameEnd, end, [&](std::string_view attr, const char* v, const char* vEnd) {
+                if (attr == "d") { d = v; dEnd = vEnd; }
+                else if (attr == "transform") { transform = v; transformEnd = vEnd; }
+            });
+            if (close >= end) break;
+            p = close + 1;
+
+            if (closing) {
+                if (IsHiddenContainer(tag)) hiddenDepth = std::max(0, hiddenDepth - 1);
+                if (stack.size() > 1) stack.pop_back();
+                continue;
+            }
+
+            uint32_t own = stack.back();
+            if (transform) {
+                transforms.push_back(transforms[own] * Affine::Parse(transform, transformEnd));
+                own = (uint32_t)transforms.size() - 1;
+            }
+            const bool selfClosing = close[-1] == '/';
+            if (!selfClosing) stack.push_back(own);
+
+            Kind kind;
+            if (IsHiddenContainer(tag)) {
+                if (!selfClosing) ++hiddenDepth;
+            } else if (hiddenDepth == 0 && ShapeKind(tag, kind)) {
+                ++elements;
+                if (kind == Kind::Path) {
+                    if (d) AddPath(d - data, dEnd - data, own);
+                } else {
+                    runs.push_back({ (size_t)(nameEnd - data), (size_t)(close - data), own, kind });
+                }
+            }
+        }
+    }
+
+    void AddPath(size_t begin, size_t end, uint32_t transform) {
+        const char* data = file.Data();
+        size_t runStart = begin;
+        for (size_t i = begin; i < end; ++i) {
+            if (data[i] == 'M' && i - runStart >= RUN_BYTES) {
+                runs.push_back({ runStart, i, transform, Kind::Path });
+                runStart = i;
+            }
+        }
+        runs.push_back({ runStart, end, transform, Kind::Path });
+    }
+
+    template<typename Fn>
+    void Emit(const Run& run, Fn&& fn) const {
+        const char* begin = file.Data() + run.begin;
+        const char* end = file.Data() + run.end;
+        if (run.kind == Kind::Path) {
+            PathData::Parse(begin, end, fn);
+            return;
+        }
+
+        // Basic shapes, converted as nanosvg does
+        double x = 0, y = 0, w = 0, h = 0, rx = -1, ry = -1, cx = 0, cy = 0, r = 0;
+        double x1 = 0, y1 = 0, x2 = 0, y2 = 0;
+        const char* points = nullptr;
+        const char* pointsEnd = nullptr;
+        Attributes(begin, end, [&](std::string_view attr, const char* v, const char* vEnd) {
+            double value = 0.0;
+            if (attr == "points") { points = v; pointsEnd = vEnd; return; }
+            if (!PathData::Numbers(v, vEnd, &value, 1)) return;
+            if (attr == "x") x = value;
+            else if (attr == "y") y = value;
+            else if (attr == "width") w = value;
+            else if (attr == "height") h = value;
+            else if (attr == "rx") rx = value;
+            else if (attr == "ry") ry = value;
+            else if (attr == "cx") cx = value;
+            else if (attr == "cy") cy = value;
+            else if (attr == "r") r = value;
+            else if (attr == "x1") x1 = value;
+            else if (attr == "y1") y1 = value;
+            else if (attr == "x2") x2 = value;
+            else if (attr == "y2") y2 = value;
+        });
+
+        switch (run.kind) {
+            case Kind::Rect: {
+                if (w <= 0.0 || h <= 0.0) return;
+                if (rx < 0.0 && ry > 0.0) rx = ry;
+                if (ry < 0.0 && rx > 0.0) ry = rx;
+                rx = std::clamp(rx, 0.0, w * 0.5);
+                ry = std::clamp(ry, 0.0, h * 0.5);
+                if (rx < 1e-5 || ry < 1e-5) {
+                    const glm::dvec2 c[4] = { { x, y }, { x + w, y }, { x + w, y + h }, { x, y + h } };
+                    for (int i = 0; i < 4; ++i) fn(Cubic::Line(c[i], c[(i + 1) % 4]));
+                } else {
+                    // Straight edge then quarter ellipse, clockwise from the top left
+                    const glm::dvec2 start(x + rx, y);
+                    glm::dvec2 cur = start;
+                    auto line = [&](glm::dvec2 to) { fn(Cubic::Line(cur, to)); cur = to; };
+                    auto corner = [&](glm::dvec2 c1, glm::dvec2 c2, glm::dvec2 to) { fn(Cubic{ cur, c1, c2, to }); cur = to; };
+                    const double kx = rx * (1.0 - KAPPA), ky = ry * (1.0 - KAPPA);
+                    line({ x + w - rx, y });
+                    corner({ x + w - kx, y }, { x + w, y + ky }, { x + w, y + ry });
+                    line({ x + w, y + h - ry });
+                    corner({ x + w, y + h - ky }, { x + w - kx, y + h }, { x + w - rx, y + h });
+                    line({ x + rx, y + h });
+                    corner({ x + kx, y + h }, { x, y + h - ky }, { x, y + h - ry });
+                    line({ x, y + ry });
+                    corner({ x, y + ky }, { x + kx, y }, start);
+                }
+                return;
+            }
+            case Kind::Circle:
+            case Kind::Ellipse: {
+                if (run.kind == Kind::Circle) rx = ry = r;
+                if (rx <= 0.0 || ry <= 0.0) return;
+                const double kx = rx * KAPPA, ky = ry * KAPPA;
+                fn(Cubic{ { cx + rx, cy }, { cx + rx, cy + ky }, { cx + kx, cy + ry }, { cx, cy + ry } });
+                fn(Cubic{ { cx, cy + ry }, { cx - kx, cy + ry }, { cx - rx, cy + ky }, { cx - rx, cy } });
+                fn(Cubic{ { cx - rx, cy }, { cx - rx, cy - ky }, { cx - kx, cy - ry }, { cx, cy - ry } });
+                fn(Cubic{ { cx, cy - ry }, { cx + kx, cy - ry }, { cx + rx, cy - ky }, { cx + rx, cy } });
+                return;
+            }
+            case Kind::Line:
+                fn(Cubic::Line({ x1, y1 }, { x2, y2 }));
+                return;
+            case Kind::Polyline:
+            case Kind::Polygon: {
+                if (!points) return;
+                double xy[2];
+                if (!PathData::Numbers(points, pointsEnd, xy, 2)) return;
+                const glm::dvec2 first(xy[0], xy[1]);
+                glm::dvec2 cur = first;
+                while (PathData::Numbers(points, pointsEnd, xy, 2)) {
+                    fn(Cubic::Line(cur, { xy[0], xy[1] }));
+                    cur = glm::dvec2(xy[0], xy[1]);
+                }
+                if (run.kind == Kind::Polygon && cur != first) fn(Cubic::Line(cur, first));
+                return;
+            }
+            default:
+                return;
+        }
+    }
+};
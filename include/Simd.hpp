@@ -0,0 +1,106 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <atomic>
+
+// --- SIMD Support ---
+// Kernels are written once as always-inline templates over the lane count
+// W and instantiated inside small wrappers compiled for each ISA. The
+// wrapper to call is picked at runtime from the CPU's feature flags, so
+// the binary itself only assumes the x86-64 baseline (SSE2).
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #define FF_SIMD_X86 1
+    #define FF_TARGET_AVX2 __attribute__((target("avx2,fma")))
+    #define FF_TARGET_AVX512 __attribute__((target("avx512f,avx512dq")))
+#else
+    #define FF_SIMD_X86 0
+    #define FF_TARGET_AVX2
+    #define FF_TARGET_AVX512
+#endif
+
+#if defined(__GNUC__)
+    #define FF_ALWAYS_INLINE inline __attribute__((always_inline))
+#else
+    #define FF_ALWAYS_INLINE inline
+#endif
+
+class Simd {
+public:
+    enum class Level { SSE2 = 0, AVX2 = 1, AVX512 = 2 };
+
+    // Widest lane count any kernel uses (AVX-512, doubles). Batched buffers
+    // are padded to a multiple of this and aligned to ALIGNMENT bytes.
+    static constexpr size_t MAX_LANES = 8;
+    static constexpr size_t ALIGNMENT = 64;
+
+    // Best level this CPU supports, unless capped by SetLevel().
+    static Level Active() {
+        Level best = Detected();
+        Level cap = (Level)capLevel().load();
+        return (int)cap < (int)best ? cap : best;
+    }
+
+    // Caps dispatch at the given level (benchmarks, A/B checks).
+    static void SetLevel(Level level) { capLevel() = (int)level; }
+
+    static Level Detected() {
+        static const Level level = []() {
+#if FF_SIMD_X86
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq")) return Level::AVX512;
+            if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return Level::AVX2;
+#endif
+            return Level::SSE2;
+        }();
+        return level;
+    }
+
+    static const char* Name(Level level) {
+        switch (level) {
+            case Level::AVX512: return "AVX-512";
+            case Level::AVX2: return "AVX2";
+            default: return "SSE2";
+        }
+    }
+
+    static size_t PadLanes(size_t count) {
+        return (count + MAX_LANES - 1) / MAX_LANES * MAX_LANES;
+    }
+
+    // --- Aligned Storage ---
+    template<typename T>
+    struct AlignedAllocator {
+        using value_type = T;
+        AlignedAllocator() = default;
+        template<typename U> AlignedAllocator(const AlignedAllocator<U>&) {}
+
+        T* allocate(size_t n) {
+            size_t bytes = (n * sizeof(T) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+            void* p = std::aligned_alloc(ALIGNMENT, bytes == 0 ? ALIGNMENT : bytes);
+            if (!p) throw std::bad_alloc();
+            return static_cast<T*>(p);
+        }
+        void deallocate(T* p, size_t) { std::free(p); }
+
+        template<typename U> bool operator==(const AlignedAllocator<U>&) const { return true; }
+        template<typename U> bool operator!=(const AlignedAllocator<U>&) const { return false; }
+    };
+
+    template<typename T>
+    using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+    // W doubles in one register (GCC/Clang vector extension).
+    template<int W>
+    struct VecD {
+        typedef double type __attribute__((vector_size(W * sizeof(double))));
+    };
+
+private:
+    static std::atomic<int>& capLevel() {
+        static std::atomic<int> level{(int)Level::AVX512};
+        return level;
+    }
+};
@@ -0,0 +1,275 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <fstream>
+#include <filesystem>
+#include <optional>
+#include <system_error>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <cstdio>
+#include <atomic>
+#include <chrono>
+#if defined(_WIN32)
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+#include <glm/glm.hpp>
+
+#include "FourierCore.hpp"
+#include "SVGStream.hpp"
+
+// --- On-Disk Spectrum Cache ---
+// Finished loads are stored as .ffspec files, named after the SVG's
+// content hash and a hash of the load settings, in the user cache
+// directory. A hit is memory-mapped, checked, and copied straight into the
+// load result, so no parse, resample or transform runs.
+//
+// Layout (native byte order, every section 8-byte aligned):
+//   Header      magic, VERSION, part count, content hash, settings hash,
+//               requested sample count, payload size, payload checksum
+//   Counts      per part: sample count, coefficient count
+//   Points      per part: samples as float x, y
+//   Records     per part: coefficients amplitude-sorted as double re, im
+//               and int32 frequency (amp and phase are rebuilt on load)
+//
+// A version, magic, key or checksum mismatch counts as a miss. Least
+// recently used files (by modification time, refreshed on every hit) are
+// evicted once the directory holds more than MAX_BYTES or MAX_FILES.
+// Temporary files a crashed writer left behind are removed once they are
+// older than STALE_TEMP.
+class SpectrumCache {
+public:
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uintmax_t MAX_BYTES = 512ull << 20;
+    static constexpr size_t MAX_FILES = 1024;
+    static constexpr std::chrono::minutes STALE_TEMP{1};
+
+    struct Key {
+        uint64_t content = 0;   // MappedFile::Hash of the SVG
+        uint64_t settings = 0;  // everything else the result depends on
+        int samples = 0;        // requested sample count (also part of `settings`)
+    };
+
+    // $XDG_CACHE_HOME/fourier-forge, ~/.cache/fourier-forge, or
+    // %LOCALAPPDATA%\fourier-forge, unless set. An empty path disables
+    // the cache.
+    static std::filesystem::path Directory() {
+        if (const auto& configured = configuredDirectory()) return *configured;
+        if (const char* xdg = std::getenv("XDG_CACHE_HOME"); xdg && *xdg) return std::filesystem::path(xdg) / "fourier-forge";
+        if (const char* home = std::getenv("HOME"); home && *home) {
+            return std::filesystem::path(home) / ".cache" / "fourier-forge";
+        }
+        if (const char* local = std::getenv("LOCALAPPDATA"); local && *local) {
+            return std::filesystem::path(local) / "fourier-forge";
+        }
+        return {};
+    }
+
+    static void SetDirectory(const std::filesystem::path& directory) { configuredDirectory() = directory; }
+
+    static bool Load(const Key& key, std::vector<std::vector<glm::vec2>>& parts,
+                     std::vector<std::vector<Epicycle>>& spectra) {
+        const std::filesystem::path path = PathFor(key);
+        if (path.empty()) return false;
+        MappedFile file;
+        if (!file.Open(path.string()) || file.Size() < sizeof(Header)) return false;
+
+        Header header;
+        std::memcpy(&header, file.Data(), sizeof(Header));
+        const size_t payload = file.Size() - sizeof(Header);
+        if (std::memcmp(header.magic, MAGIC, sizeof(header.magic)) != 0 || header.version != VERSION ||
+            header.content != key.content || header.settings != key.settings || header.samples != key.samples ||
+            header.payloadBytes != payload || (uint64_t)header.parts * sizeof(Counts) > payload ||
+            MappedFile::Hash(file.Data() + sizeof(Header), payload) != header.checksum) {
+            return false;
+        }
+
+        const char* p = file.Data() + sizeof(Header);
+        std::vector<Counts> counts(header.parts);
+        if (!counts.empty()) std::memcpy(counts.data(), p, counts.size() * sizeof(Counts));
+        p += counts.size() * sizeof(Counts);
+        // Bound every count by the payload before multiplying, so crafted
+        // counts cannot wrap the sum
+        uint64_t expected = counts.size() * sizeof(Counts);
+        for (const auto& c : counts) {
+            if (c.points > payload / sizeof(glm::vec2) || c.coefficients > payload / sizeof(Record)) return false;
+            expected += c.points * sizeof(glm::vec2) + c.coefficients * sizeof(Record);
+            if (expected > payload) return false;
+        }
+        if (expected != payload) return false;
+
+        parts.assign(counts.size(), {});
+        spectra.assign(counts.size(), {});
+        for (size_t i = 0; i < counts.size(); ++i) {
+            parts[i].resize(counts[i].points);
+            if (counts[i].points > 0) std::memcpy(parts[i].data(), p, counts[i].points * sizeof(glm::vec2));
+            p += counts[i].points * sizeof(glm::vec2);
+        }
+        for (size_t i = 0; i < counts.size(); ++i) {
+            spectra[i].resize(counts[i].coefficients);
+            for (auto& e : spectra[i]) {
+                Record r;
+                std::memcpy(&r, p, sizeof(Record));
+                p += sizeof(Record);
+                e.value = std::complex<double>(r.re, r.im);
+                e.frequency = r.frequency;
+                e.amp = (float)std::abs(e.value);
+                e.phase = (float)std::arg(e.value);
+            }
+        }
+        file.Close();
+
+        std::error_code ec;
+        std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), ec);  // LRU touch
+        return true;
+    }
+
+    // Writes to a temporary file first and renames it into place, so a
+    // concurrent reader never maps a half-written entry. The temporary name
+    // is unique per process and write, so processes sharing the directory
+    // never write into each other's file.
+    static void Store(const Key& key, const std::vector<std::vector<glm::vec2>>& parts,
+                      const std::vector<std::vector<Epicycle>>& spectra) {
+        const std::filesystem::path path = PathFor(key);
+        if (path.empty() || parts.size() != spectra.size()) return;
+        std::error_code ec;
+        std::filesystem::create_directories(path.parent_path(), ec);
+        if (ec) return;
+
+        std::string payload;
+        for (size_t i = 0; i < parts.size(); ++i) {
+            const Counts c{ parts[i].size(), spectra[i].size() };
+            payload.append((const char*)&c, sizeof(Counts));
+        }
+        for (const auto& part : parts) payload.append((const char*)part.data(), part.size() * sizeof(glm::vec2));
+        for (const auto& spectrum : spectra) {
+            for (const auto& e : spectrum) {
+                const Record r{ e.value.real(), e.value.imag(), e.frequency, 0 };
+                payload.append((const char*)&r, sizeof(Record));
+            }
+        }
+
+        Header header;
+        std::memcpy(header.magic, MAGIC, sizeof(header.magic));
+        header.version = VERSION;
+        header.parts = (uint32_t)parts.size();
+        header.content = key.content;
+        header.settings = key.settings;
+        header.samples = key.samples;
+        header.payloadBytes = payload.size();
+        header.checksum = MappedFile::Hash(payload.data(), payload.size());
+
+        static std::atomic<uint64_t> writes{0};
+        char suffix[64];
+        std::snprintf(suffix, sizeof(suffix), ".%lld-%llu.tmp", (long long)ProcessId(),
+                      (unsigned long long)writes.fetch_add(1));
+        std::filesystem::path temp = path;
+        temp += suffix;
+        {
+            std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+            out.write((const char*)&header, sizeof(Header));
+            out.write(payload.data(), (std::streamsize)payload.size());
+            if (!out) {
+                out.close();
+                std::filesystem::remove(temp, ec);
+                return;
+            }
+        }
+        std::filesystem::rename(temp, path, ec);
+        if (ec) {
+            std::filesystem::remove(temp, ec);
+            return;
+        }
+        Evict(path.parent_path());
+    }
+
+private:
+    static constexpr char MAGIC[8] = { 'F', 'F', 'S', 'P', 'E', 'C', '\0', '\n' };
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t parts;
+        uint64_t content;
+        uint64_t settings;
+        int32_t samples;
+        uint32_t reserved = 0;
+        uint64_t payloadBytes;
+        uint64_t checksum;
+    };
+    struct Counts {
+        uint64_t points, coefficients;
+    };
+    struct Record {
+        double re, im;
+        int32_t frequency, reserved;
+    };
+    static_assert(sizeof(Header) % 8 == 0 && sizeof(Counts) == 16 && sizeof(Record) == 24 && sizeof(glm::vec2) == 8,
+                  ".ffspec sections must stay 8-byte aligned");
+
+    static std::optional<std::filesystem::path>& configuredDirectory() {
+        static std::optional<std::filesystem::path> directory;
+        return directory;
+    }
+
+    static long long ProcessId() {
+#if defined(_WIN32)
+        return (long long)_getpid();
+#else
+        return (long long)getpid();
+#endif
+    }
+
+    static std::filesystem::path PathFor(const Key& key) {
+        const std::filesystem::path dir = Directory();
+        if (dir.empty()) return {};
+        char name[64];
+        std::snprintf(name, sizeof(name), "%016llx-%016llx.ffspec", (unsigned long long)key.content,
+                      (unsigned long long)key.settings);
+        return dir / name;
+    }
+
+    // Oldest first until both limits hold again.
+    static void Evict(const std::filesystem::path& dir) {
+        struct Entry {
+            std::filesystem::path path;
+            std::filesystem::file_time_type used;
+            uintmax_t bytes;
+        };
+        std::vector<Entry> entries;
+        uintmax_t total = 0;
+        std::error_code ec;
+        const auto now = std::filesystem::file_time_type::clock::now();
+        for (const auto& item : std::filesystem::directory_iterator(dir, ec)) {
+            // <entry>.ffspec.<pid>-<n>.tmp, from Store
+            if (item.path().extension() == ".tmp" && item.path().stem().string().find(".ffspec.") != std::string::npos) {
+                std::error_code tempEc;
+                const auto written = item.last_write_time(tempEc);
+                if (!tempEc && now - written > STALE_TEMP) std::filesystem::remove(item.path(), tempEc);
+                continue;
+            }
+            if (item.path().extension() != ".ffspec") continue;
+            std::error_code itemEc;
+            Entry e{ item.path(), item.last_write_time(itemEc), item.file_size(itemEc) };
+            if (itemEc) continue;
+            total += e.bytes;
+            entries.push_back(std::move(e));
+        }
+        if (total <= MAX_BYTES && entries.size() <= MAX_FILES) return;
+
+        std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.used < b.used; });
+        size_t files = entries.size();
+        for (const auto& e : entries) {
+            if (total <= MAX_BYTES && files <= MAX_FILES) break;
+            std::error_code removeEc;
+            if (std::filesystem::remove(e.path, removeEc)) {
+                total -= e.bytes;
+                --files;
+            }
+        }
+    }
+};
@@ -0,0 +1,304 @@
+#pragma once
+#include <vector>
+#include <complex>
+#include <memory>
+#include <mutex>
+#include <array>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+
+#include "FourierCore.hpp"
+#include "Simd.hpp"
+
+// --- Spectrum Codec ---
+// Compact, lossy encoding of an epicycle spectrum for storage and transfer.
+// Coefficients are stored in frequency order:
+//   Frequencies  first one in the header, then each gap minus one as a
+//                LEB128 varint (one byte each for a dense band)
+//   Codes        amplitude and phase quantized to ampBits / phaseBits and
+//                packed into one (ampBits + phaseBits)-bit field each
+// Amplitude is quantized linearly up to the largest one, so the error per
+// coefficient is absolute; coefficients that round to zero amplitude are
+// dropped. Phase is quantized uniformly over the full turn.
+//
+// Errors are reported in path units, which are pixels at zoom 1 (the path
+// spans 1000). By Parseval the RMS distance between the original and
+// decoded curves is the root sum of squared coefficient errors, and no
+// point of the curve moves further than their plain sum.
+//
+// Decoding returns the spectrum amplitude-sorted again (a counting sort on
+// the quantized amplitude), with amp and phase filled in. Phases come from
+// small per-depth rotation tables, so decoding runs no trig, and the
+// dequantization runs W coefficients per register.
+class SpectrumCodec {
+public:
+    static constexpr uint8_t VERSION = 1;
+    static constexpr int MAX_BITS = 16;  // per field
+
+    struct Error {
+        double rms = 0.0;       // RMS curve distance
+        double peak = 0.0;      // bound on the distance at any point of the curve
+        double largest = 0.0;   // largest single-coefficient error
+        size_t dropped = 0;     // coefficients that quantized to zero amplitude
+    };
+
+    static std::vector<uint8_t> Encode(const std::vector<Epicycle>& spectrum, int ampBits = 16, int phaseBits = 16,
+                                       Error* error = nullptr) {
+        ampBits = std::clamp(ampBits, 1, MAX_BITS);
+        phaseBits = std::clamp(phaseBits, 1, MAX_BITS);
+        const uint32_t ampLevels = (1u << ampBits) - 1;
+        const uint32_t phaseLevels = 1u << phaseBits;
+        const PhaseTable& table = Table(phaseBits);
+
+        std::vector<const Epicycle*> order(spectrum.size());
+        for (size_t i = 0; i < spectrum.size(); ++i) order[i] = &spectrum[i];
+        std::sort(order.begin(), order.end(), [](const Epicycle* a, const Epicycle* b) { return a->frequency < b->frequency; });
+
+        double ampScale = 0.0;
+        for (const auto& e : spectrum) ampScale = std::max(ampScale, std::abs(e.value));
+        if (ampScale <= 0.0) ampScale = 1.0;
+        const double ampStep = ampScale / ampLevels;
+
+        Error err;
+        double squared = 0.0;
+        std::vector<int32_t> freqs;
+        std::vector<uint32_t> codes;
+        for (const Epicycle* e : order) {
+            const uint32_t qa = (uint32_t)std::lround(std::abs(e->value) / ampStep);
+            std::complex<double> decoded(0.0, 0.0);
+            if (qa == 0) {
+                ++err.dropped;
+            } else {
+                const double turn = (std::arg(e->value) + M_PI) / (2.0 * M_PI);
+                const uint32_t qp = (uint32_t)std::lround(turn * phaseLevels) & (phaseLevels - 1);
+                decoded = Rotation(table, qp) * (qa * ampStep);
+                freqs.push_back(e->frequency);
+                codes.push_back(qa << phaseBits | qp);
+            }
+            const double d = std::abs(e->value - decoded);
+            squared += d * d;
+            err.peak += d;
+            err.largest = std::max(err.largest, d);
+        }
+        err.rms = std::sqrt(squared);
+        if (error) *error = err;
+
+        std::vector<uint8_t> out(sizeof(Header));
+        for (size_t i = 1; i < freqs.size(); ++i) {
+            uint32_t gap = (uint32_t)(freqs[i] - freqs[i - 1] - 1);
+            do {
+                out.push_back((uint8_t)(gap & 0x7F) | (gap >= 0x80 ? 0x80 : 0));
+                gap >>= 7;
+            } while (gap != 0);
+        }
+        const size_t freqBytes = out.size() - sizeof(Header);
+
+        const int bits = ampBits + phaseBits;
+        uint64_t buffer = 0;
+        int filled = 0;
+        for (uint32_t code : codes) {
+            buffer |= (uint64_t)code << filled;
+            filled += bits;
+            while (filled >= 8) {
+                out.push_back((uint8_t)buffer);
+                buffer >>= 8;
+                filled -= 8;
+            }
+        }
+        if (filled > 0) out.push_back((uint8_t)buffer);
+        out.insert(out.end(), 8, 0);  // lets the decoder load 8 bytes at any code
+
+        Header header;
+        std::memcpy(header.magic, MAGIC, sizeof(header.magic));
+        header.version = VERSION;
+        header.ampBits = (uint8_t)ampBits;
+        header.phaseBits = (uint8_t)phaseBits;
+        header.count = (uint32_t)codes.size();
+        header.firstFrequency = freqs.empty() ? 0 : freqs[0];
+        header.frequencyBytes = (uint32_t)freqBytes;
+        header.ampScale = ampScale;
+        std::memcpy(out.data(), &header, sizeof(Header));
+        return out;
+    }
+
+    // False (with `spectrum` untouched) on a malformed or foreign buffer.
+    static bool Decode(const uint8_t* data, size_t size, std::vector<Epicycle>& spectrum) {
+        if (size < sizeof(Header)) return false;
+        Header header;
+        std::memcpy(&header, data, sizeof(Header));
+        if (std::memcmp(header.magic, MAGIC, sizeof(header.magic)) != 0 || header.version != VERSION ||
+            header.ampBits < 1 || header.ampBits > MAX_BITS || header.phaseBits < 1 || header.phaseBits > MAX_BITS) {
+            return false;
+        }
+        const size_t count = header.count;
+        const int bits = header.ampBits + header.phaseBits;
+        const size_t codeBytes = (count * bits + 7) / 8 + 8;
+        if (size - sizeof(Header) < (size_t)header.frequencyBytes ||
+            size - sizeof(Header) - header.frequencyBytes != codeBytes) {
+            return false;
+        }
+
+        // Frequencies
+        std::vector<int32_t> freqs(count);
+        const uint8_t* p = data + sizeof(Header);
+        const uint8_t* freqEnd = p + header.frequencyBytes;
+        if (count > 0) freqs[0] = header.firstFrequency;
+        for (size_t i = 1; i < count; ++i) {
+            uint32_t gap = 0;
+            int shift = 0;
+            for (;;) {
+                if (p == freqEnd || shift > 28) return false;
+                const uint8_t byte = *p++;
+                gap |= (uint32_t)(byte & 0x7F) << shift;
+                shift += 7;
+                if (!(byte & 0x80)) break;
+            }
+            freqs[i] = freqs[i - 1] + (int32_t)gap + 1;
+        }
+        if (p != freqEnd) return false;
+
+        // Codes
+        const size_t padded = Simd::PadLanes(count);
+        std::vector<uint32_t> codes(count);
+        const uint64_t mask = (1ull << bits) - 1;
+        for (size_t i = 0; i < count; ++i) {
+            const size_t bit = i * bits;
+            uint64_t word;
+            std::memcpy(&word, p + bit / 8, 8);
+            codes[i] = (uint32_t)((word >> (bit % 8)) & mask);
+        }
+
+        // Counting sort on the quantized amplitude, largest first
+        const int phaseBits = header.phaseBits;
+        const uint32_t top = (1u << header.ampBits) - 1;
+        std::vector<uint32_t> start((size_t)top + 2, 0);
+        for (size_t i = 0; i < count; ++i) ++start[top - (codes[i] >> phaseBits) + 1];
+        for (size_t b = 1; b < start.size(); ++b) start[b] += start[b - 1];
+        Simd::AlignedVector<uint32_t> sorted(padded, 0);
+        std::vector<int32_t> sortedFreqs(count);
+        for (size_t i = 0; i < count; ++i) {
+            const uint32_t at = start[top - (codes[i] >> phaseBits)]++;
+            sorted[at] = codes[i];
+            sortedFreqs[at] = freqs[i];
+        }
+
+        spectrum.resize(count);
+        Dequantize(sorted.data(), sortedFreqs.data(), count, phaseBits, header.ampScale / top, Table(phaseBits),
+                   spectrum.data());
+        return true;
+    }
+
+    static bool Decode(const std::vector<uint8_t>& buffer, std::vector<Epicycle>& spectrum) {
+        return Decode(buffer.data(), buffer.size(), spectrum);
+    }
+
+private:
+    static constexpr char MAGIC[4] = { 'F', 'F', 'S', 'C' };
+
+    struct Header {
+        char magic[4];
+        uint8_t version;
+        uint8_t ampBits;
+        uint8_t phaseBits;
+        uint8_t reserved = 0;
+        uint32_t count;           // coefficients stored
+        int32_t firstFrequency;
+        uint32_t frequencyBytes;  // varint section size
+        uint32_t reserved2 = 0;
+        double ampScale;          // largest amplitude (the top quantization level)
+    };
+    static_assert(sizeof(Header) == 32, "SpectrumCodec header layout");
+
+    // e^(i (2 pi k / 2^bits - pi)) for phase code k = hi * 2^lowBits + lo
+    // is coarse[hi] * fine[lo]: two tables of at most 256 entries, so
+    // lookups stay in L1 at every depth.
+    struct PhaseTable {
+        int lowBits;
+        std::vector<double> coarseRe, coarseIm, fineRe, fineIm;
+    };
+
+    static const PhaseTable& Table(int bits) {
+        static std::mutex mutex;
+        static std::array<std::unique_ptr<PhaseTable>, MAX_BITS + 1> tables;
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!tables[bits]) {
+            auto table = std::make_unique<PhaseTable>();
+            table->lowBits = bits / 2;
+            const double step = 2.0 * M_PI / (double)(size_t(1) << bits);
+            for (size_t hi = 0; hi < (size_t(1) << (bits - table->lowBits)); ++hi) {
+                const double angle = (double)(hi << table->lowBits) * step - M_PI;
+                table->coarseRe.push_back(std::cos(angle));
+                table->coarseIm.push_back(std::sin(angle));
+            }
+            for (size_t lo = 0; lo < (size_t(1) << table->lowBits); ++lo) {
+                table->fineRe.push_back(std::cos((double)lo * step));
+                table->fineIm.push_back(std::sin((double)lo * step));
+            }
+            tables[bits] = std::move(table);
+        }
+        return *tables[bits];
+    }
+
+    static std::complex<double> Rotation(const PhaseTable& table, uint32_t k) {
+        const uint32_t hi = k >> table.lowBits, lo = k & ((1u << table.lowBits) - 1);
+        return std::complex<double>(table.coarseRe[hi], table.coarseIm[hi]) *
+               std::complex<double>(table.fineRe[lo], table.fineIm[lo]);
+    }
+
+    // Amplitude-sorted codes -> epicycles. `codes` is padded to a
+    // multiple of the widest register (Simd::PadLanes).
+    static void Dequantize(const uint32_t* codes, const int32_t* freqs, size_t count, int phaseBits, double ampStep,
+                           const PhaseTable& table, Epicycle* out) {
+#if FF_SIMD_X86
+        switch (Simd::Active()) {
+            case Simd::Level::AVX512: DequantizeAVX512(codes, freqs, count, phaseBits, ampStep, table, out); return;
+            case Simd::Level::AVX2: DequantizeAVX2(codes, freqs, count, phaseBits, ampStep, table, out); return;
+            default: break;
+        }
+#endif
+        DequantizeKernel<2>(codes, freqs, count, phaseBits, ampStep, table, out);
+    }
+
+#if FF_SIMD_X86
+    FF_TARGET_AVX512 static void DequantizeAVX512(const uint32_t* codes, const int32_t* freqs, size_t count,
+                                                  int phaseBits, double ampStep, const PhaseTable& table,
+                                                  Epicycle* out) {
+        DequantizeKernel<8>(codes, freqs, count, phaseBits, ampStep, table, out);
+    }
+    FF_TARGET_AVX2 static void DequantizeAVX2(const uint32_t* codes, const int32_t* freqs, size_t count,
+                                              int phaseBits, double ampStep, const PhaseTable& table, Epicycle* out) {
+        DequantizeKernel<4>(codes, freqs, count, phaseBits, ampStep, table, out);
+    }
+#endif
+
+    template<int W>
+    FF_ALWAYS_INLINE static void DequantizeKernel(const uint32_t* codes, const int32_t* freqs, size_t count,
+                                                  int phaseBits, double ampStep, const PhaseTable& table,
+                                                  Epicycle* out) {
+        using V = typename Simd::VecD<W>::type;
+        const uint32_t mask = (1u << phaseBits) - 1, lowMask = (1u << table.lowBits) - 1;
+        const double phaseStep = 2.0 * M_PI / (double)(1u << phaseBits);
+        for (size_t i = 0; i < count; i += W) {
+            V qa, qp, cr, ci, fr, fi;
+            for (int j = 0; j < W; ++j) {
+                const uint32_t code = codes[i + j];
+                const uint32_t k = code & mask, hi = k >> table.lowBits, lo = k & lowMask;
+                qa[j] = (double)(code >> phaseBits);
+                qp[j] = (double)k;
+                cr[j] = table.coarseRe[hi];
+                ci[j] = table.coarseIm[hi];
+                fr[j] = table.fineRe[lo];
+                fi[j] = table.fineIm[lo];
+            }
+            const V a = qa * ampStep;
+            const V re = a * (cr * fr - ci * fi);
+            const V im = a * (cr * fi + ci * fr);
+            const V phase = qp * phaseStep - M_PI;
+            for (int j = 0; j < W && i + j < count; ++j) {
+                out[i + j] = { std::complex<double>(re[j], im[j]), freqs[i + j], (float)a[j], (float)phase[j] };
+            }
+        }
+    }
+};
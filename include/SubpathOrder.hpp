@@ -0,0 +1,186 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+#include "Bezier.hpp"
+#include "ThreadPool.hpp"
+
+// --- Subpath Ordering ---
+// A drawing kept as one closed signal jumps in a straight line from the end
+// of each subpath to the start of the next, and from the last back to the
+// first. Those jumps are sharp corners the spectrum pays for in circles.
+// Each subpath may be drawn in either direction and in any order, so
+// shortening the total jump length is a small travelling-salesman problem
+// over oriented subpaths:
+//
+//   1. Greedy nearest neighbour: from the pen position, take the closest
+//      free endpoint (its subpath is drawn away from it), using a uniform
+//      grid over the endpoints.
+//   2. 2-opt: reverse any run of the tour (which also flips each subpath in
+//      it) while that shortens the two jumps at its ends. Quadratic per
+//      pass, so only up to TWO_OPT_LIMIT subpaths, and no further passes
+//      once the calling scope is cancelled (ThreadPool::Cancelled).
+//
+// The closing jump counts as part of the tour. The document order is kept
+// when the optimized tour is not shorter.
+class SubpathOrder {
+public:
+    static constexpr size_t TWO_OPT_LIMIT = 2000;
+    static constexpr int TWO_OPT_PASSES = 50;
+
+    struct Result {
+        double before = 0.0, after = 0.0;  // total jump length, closure included
+    };
+
+    static Result Optimize(std::vector<std::vector<Cubic>>& subpaths) {
+        const size_t n = subpaths.size();
+        std::vector<glm::dvec2> starts(n), ends(n);
+        for (size_t i = 0; i < n; ++i) {
+            starts[i] = subpaths[i].front().p0;
+            ends[i] = subpaths[i].back().p3;
+        }
+
+        std::vector<Step> tour(n);
+        for (size_t i = 0; i < n; ++i) tour[i] = { (uint32_t)i, false };
+        Result result;
+        result.before = result.after = Travel(tour, starts, ends);
+        if (n < 2) return result;
+
+        tour = Greedy(starts, ends);
+        if (n <= TWO_OPT_LIMIT) TwoOpt(tour, starts, ends);
+        const double travel = Travel(tour, starts, ends);
+        if (travel >= result.before) return result;
+        result.after = travel;
+
+        std::vector<std::vector<Cubic>> ordered;
+        ordered.reserve(n);
+        for (const Step& step : tour) {
+            std::vector<Cubic> sub = std::move(subpaths[step.index]);
+            if (step.reversed) {
+                std::reverse(sub.begin(), sub.end());
+                for (auto& c : sub) c = { c.p3, c.p2, c.p1, c.p0 };
+            }
+            ordered.push_back(std::move(sub));
+        }
+        subpaths = std::move(ordered);
+        return result;
+    }
+
+private:
+    struct Step {
+        uint32_t index;
+        bool reversed;
+    };
+
+    static glm::dvec2 Entry(const Step& s, const std::vector<glm::dvec2>& starts, const std::vector<glm::dvec2>& ends) {
+        return s.reversed ? ends[s.index] : starts[s.index];
+    }
+    static glm::dvec2 Exit(const Step& s, const std::vector<glm::dvec2>& starts, const std::vector<glm::dvec2>& ends) {
+        return s.reversed ? starts[s.index] : ends[s.index];
+    }
+
+    static double Travel(const std::vector<Step>& tour, const std::vector<glm::dvec2>& starts,
+                         const std::vector<glm::dvec2>& ends) {
+        double total = 0.0;
+        for (size_t k = 0; k < tour.size(); ++k) {
+            total += glm::distance(Exit(tour[k], starts, ends), Entry(tour[(k + 1) % tour.size()], starts, ends));
+        }
+        return total;
+    }
+
+    // Nearest free endpoint from the pen, starting with subpath 0 as drawn.
+    // Endpoint 2i is the start of subpath i and 2i + 1 its end.
+    static std::vector<Step> Greedy(const std::vector<glm::dvec2>& starts, const std::vector<glm::dvec2>& ends) {
+        const size_t n = starts.size();
+        auto point = [&](uint32_t e) { return (e & 1) ? ends[e >> 1] : starts[e >> 1]; };
+
+        glm::dvec2 lo(1e300), hi(-1e300);
+        for (size_t i = 0; i < n; ++i) {
+            lo = glm::min(lo, glm::min(starts[i], ends[i]));
+            hi = glm::max(hi, glm::max(starts[i], ends[i]));
+        }
+        const int side = std::max(1, (int)std::sqrt((double)n));
+        const double cell = std::max({ hi.x - lo.x, hi.y - lo.y, 1e-9 }) / side;
+        auto cellOf = [&](glm::dvec2 p) {
+            return glm::ivec2(std::clamp((int)((p.x - lo.x) / cell), 0, side - 1),
+                              std::clamp((int)((p.y - lo.y) / cell), 0, side - 1));
+        };
+
+        std::vector<std::vector<uint32_t>> grid((size_t)side * side);
+        for (uint32_t e = 2; e < 2 * n; ++e) {  // subpath 0 is placed first
+            const glm::ivec2 c = cellOf(point(e));
+            grid[(size_t)c.y * side + c.x].push_back(e);
+        }
+        std::vector<char> used(n, 0);
+        used[0] = 1;
+
+        std::vector<Step> tour;
+        tour.reserve(n);
+        tour.push_back({ 0, false });
+        glm::dvec2 pen = ends[0];
+        for (size_t placed = 1; placed < n; ++placed) {
+            const glm::ivec2 home = cellOf(pen);
+            uint32_t best = UINT32_MAX;
+            double bestDist = 1e300;
+            // Rings of cells around the pen; ring r + 1 lies at least r cells away
+            for (int r = 0; r <= side; ++r) {
+                if (best != UINT32_MAX && bestDist <= (r - 1) * cell) break;
+                for (int y = home.y - r; y <= home.y + r; ++y) {
+                    if (y < 0 || y >= side) continue;
+                    const int step = (y == home.y - r || y == home.y + r) ? 1 : 2 * r;
+                    for (int x = home.x - r; x <= home.x + r; x += std::max(step, 1)) {
+                        if (x < 0 || x >= side) continue;
+                        auto& bucket = grid[(size_t)y * side + x];
+                        for (size_t k = 0; k < bucket.size();) {
+                            const uint32_t e = bucket[k];
+                            if (used[e >> 1]) {  // drop endpoints of placed subpaths
+                                bucket[k] = bucket.back();
+                                bucket.pop_back();
+                                continue;
+                            }
+                            const double d = glm::distance(pen, point(e));
+                            if (d < bestDist || (d == bestDist && e < best)) { bestDist = d; best = e; }
+                            ++k;
+                        }
+                    }
+                }
+            }
+
+            const uint32_t index = best >> 1;
+            const bool reversed = (best & 1) != 0;
+            used[index] = 1;
+            tour.push_back({ index, reversed });
+            pen = reversed ? starts[index] : ends[index];
+        }
+        return tour;
+    }
+
+    // Reversing tour[i..j] replaces the jumps (i-1 -> i) and (j -> j+1) by
+    // (i-1 -> j) and (i -> j+1), with every subpath in the run flipped.
+    static void TwoOpt(std::vector<Step>& tour, const std::vector<glm::dvec2>& starts,
+                       const std::vector<glm::dvec2>& ends) {
+        const size_t n = tour.size();
+        for (int pass = 0; pass < TWO_OPT_PASSES && !ThreadPool::Cancelled(); ++pass) {
+            bool improved = false;
+            for (size_t i = 1; i < n; ++i) {
+                for (size_t j = i; j < n; ++j) {
+                    const glm::dvec2 before = Exit(tour[i - 1], starts, ends);
+                    const glm::dvec2 after = Entry(tour[(j + 1) % n], starts, ends);
+                    const double old = glm::distance(before, Entry(tour[i], starts, ends)) +
+                                       glm::distance(Exit(tour[j], starts, ends), after);
+                    const double now = glm::distance(before, Exit(tour[j], starts, ends)) +
+                                       glm::distance(Entry(tour[i], starts, ends), after);
+                    if (now < old - 1e-9) {
+                        std::reverse(tour.begin() + i, tour.begin() + j + 1);
+                        for (size_t k = i; k <= j; ++k) tour[k].reversed = !tour[k].reversed;
+                        improved = true;
+                    }
+                }
+            }
+            if (!improved) break;
+        }
+    }
+};
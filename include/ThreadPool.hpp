@@ -0,0 +1,372 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// --- Work-Stealing Thread Pool ---
+// One set of worker threads shared by everything that runs in parallel:
+// Parallel::For chunks (parsing, resampling, transforms, curve tables),
+// background loads and per-chain frame work. Blocking I/O stays off it:
+// the video writer has a thread of its own.
+//
+// Every worker owns a deque per lane. A worker pushes what it submits to
+// the back of its own deque and pops from there (newest first, still warm
+// in its cache); idle workers steal from the front of the others' deques
+// (oldest first, usually the largest piece left). Threads outside the pool
+// submit to a shared queue that workers steal from the same way.
+//
+// Lanes are strict priorities: a worker looking for work takes any
+// Interactive task, anywhere, before a Normal one, and a Normal one before
+// anything Background. Frame work therefore overtakes a running load at
+// the next chunk boundary instead of queueing behind it.
+//
+// Waiting never depends on a free worker: Group::Wait runs every task of
+// its own that nobody has started yet on the waiting thread, so fork/join
+// nested inside a task (or issued while every worker is busy) still makes
+// progress.
+//
+// Each task carries a label and a cancellation flag (both inherited from
+// the Scope it was submitted in) and is timed: Profile() reports per label
+// and lane how many ran, how long they ran and how long they sat in a
+// queue.
+class ThreadPool {
+public:
+    enum class Lane : int { Interactive, Normal, Background };
+    static constexpr int LANES = 3;
+
+    static const char* LaneName(Lane lane) {
+        switch (lane) {
+            case Lane::Interactive: return "Interactive";
+            case Lane::Normal: return "Normal";
+            case Lane::Background: return "Background";
+        }
+        return "";
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Context {
+        Lane lane = Lane::Normal;
+        const char* label = "task";  // a string literal: stats keep the pointer
+        const std::atomic<bool>* cancel = nullptr;
+    };
+    struct Task {
+        std::function<void()> fn;
+        Context context;
+        Clock::time_point queued;
+        std::atomic<bool> claimed{false}, done{false};
+    };
+
+public:
+    struct TaskStats {
+        std::string label;
+        Lane lane = Lane::Normal;
+        uint64_t count = 0;
+        double runMs = 0.0, maxMs = 0.0;  // total and longest run time
+        double waitMs = 0.0;              // total time queued before starting
+    };
+
+    // Worker count (0 = one per hardware thread) and whether worker i is
+    // pinned to CPU i. Takes effect when the pool starts, on first use.
+    static void Configure(unsigned workers, bool pinned) {
+        Config& config = configuration();
+        config.workers = workers;
+        config.pinned = pinned;
+    }
+
+    static ThreadPool& Shared() {
+        static ThreadPool pool(configuration());
+        return pool;
+    }
+
+    unsigned Workers() const { return workerCount; }
+
+    // Lane and label of tasks submitted from this thread while the scope
+    // lives. Tasks inherit the scope they were submitted from, so the
+    // chunks of a For inside a background load stay in the Background lane.
+    // A scope may also set the flag Cancelled() reads; nested scopes keep
+    // the one they are opened in.
+    class Scope {
+    public:
+        explicit Scope(const char* label) : Scope(current().lane, label) {}
+        Scope(Lane lane, const char* label) : Scope(lane, label, current().cancel) {}
+        Scope(const char* label, const std::atomic<bool>* cancel) : Scope(current().lane, label, cancel) {}
+        Scope(Lane lane, const char* label, const std::atomic<bool>* cancel) : saved(current()) {
+            current() = { lane, label, cancel };
+        }
+        ~Scope() { current() = saved; }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        Context saved;
+    };
+
+    // Whether the current scope's work has been cancelled. Long loops check
+    // this between chunks and stop early; what they return then is
+    // incomplete, and the owner of the flag discards it.
+    static bool Cancelled() {
+        const std::atomic<bool>* cancel = current().cancel;
+        return cancel && cancel->load(std::memory_order_relaxed);
+    }
+
+    // Fire and forget, in the current scope's lane and label.
+    template<typename Fn>
+    static void Submit(Fn&& fn) {
+        Shared().Push(MakeTask(std::forward<Fn>(fn)));
+    }
+
+    // Tasks that are waited for together. Reusable after Wait().
+    class Group {
+    public:
+        Group() = default;
+        ~Group() { Wait(); }
+        Group(const Group&) = delete;
+        Group& operator=(const Group&) = delete;
+
+        template<typename Fn>
+        void Run(Fn&& fn) {
+            tasks.push_back(MakeTask(std::forward<Fn>(fn)));
+            Shared().Push(tasks.back());
+        }
+
+        // Runs the tasks nobody has started here, then waits for the rest.
+        void Wait() {
+            for (const auto& task : tasks) {
+                if (!task->claimed.exchange(true, std::memory_order_acq_rel)) Execute(*task);
+            }
+            for (const auto& task : tasks) task->done.wait(false, std::memory_order_acquire);
+            tasks.clear();
+        }
+
+    private:
+        std::vector<std::shared_ptr<Task>> tasks;
+    };
+
+    // Per label and lane, summed over every thread.
+    static std::vector<TaskStats> Profile() {
+        std::vector<TaskStats> merged;
+        std::lock_guard<std::mutex> registryLock(registry().mutex);
+        for (const auto& block : registry().blocks) {
+            std::lock_guard<std::mutex> lock(block->mutex);
+            for (const auto& entry : block->entries) {
+                auto it = std::find_if(merged.begin(), merged.end(), [&](const TaskStats& s) {
+                    return s.lane == entry.lane && s.label == entry.label;
+                });
+                if (it == merged.end()) {
+                    merged.push_back({ entry.label, entry.lane });
+                    it = merged.end() - 1;
+                }
+                it->count += entry.count;
+                it->runMs += entry.runMs;
+                it->maxMs = std::max(it->maxMs, entry.maxMs);
+                it->waitMs += entry.waitMs;
+            }
+        }
+        std::sort(merged.begin(), merged.end(), [](const TaskStats& a, const TaskStats& b) { return a.runMs > b.runMs; });
+        return merged;
+    }
+
+    static void ResetProfile() {
+        std::lock_guard<std::mutex> registryLock(registry().mutex);
+        for (const auto& block : registry().blocks) {
+            std::lock_guard<std::mutex> lock(block->mutex);
+            block->entries.clear();
+        }
+    }
+
+    ~ThreadPool() {
+        stopping.store(true, std::memory_order_release);
+        epoch.fetch_add(1, std::memory_order_release);
+        epoch.notify_all();
+        for (auto& t : threads) t.join();
+    }
+
+private:
+    struct Config {
+        unsigned workers = 0;
+        bool pinned = false;
+    };
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::shared_ptr<Task>> lanes[LANES];
+    };
+
+    // One per thread that has run a task, so recording never contends.
+    struct StatsBlock {
+        struct Entry {
+            const char* label;
+            Lane lane;
+            uint64_t count;
+            double runMs, maxMs, waitMs;
+        };
+        std::mutex mutex;
+        std::vector<Entry> entries;
+    };
+    struct Registry {
+        std::mutex mutex;
+        std::vector<std::shared_ptr<StatsBlock>> blocks;
+    };
+
+    explicit ThreadPool(const Config& config)
+        : workerCount(config.workers ? config.workers : std::max(1u, std::thread::hardware_concurrency())) {
+        for (unsigned i = 0; i <= workerCount; ++i) queues.push_back(std::make_unique<Queue>());  // last: outside threads
+        threads.reserve(workerCount);
+        for (unsigned i = 0; i < workerCount; ++i) {
+            threads.emplace_back([this, i]() { WorkerLoop(i); });
+            if (config.pinned) Pin(threads.back(), i);
+        }
+    }
+
+    static Config& configuration() {
+        static Config config;
+        return config;
+    }
+    static Context& current() {
+        thread_local Context context;
+        return context;
+    }
+    static size_t& workerIndex() {  // SIZE_MAX outside the pool
+        thread_local size_t index = SIZE_MAX;
+        return index;
+    }
+    static Registry& registry() {
+        static Registry r;
+        return r;
+    }
+    static StatsBlock& stats() {
+        thread_local std::shared_ptr<StatsBlock> block = []() {
+            auto b = std::make_shared<StatsBlock>();
+            std::lock_guard<std::mutex> lock(registry().mutex);
+            registry().blocks.push_back(b);
+            return b;
+        }();
+        return *block;
+    }
+
+    static void Pin(std::thread& thread, unsigned index) {
+#if defined(__linux__)
+        const unsigned cpus = std::max(1u, std::thread::hardware_concurrency());
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(index % cpus, &set);
+        pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+#else
+        (void)thread;
+        (void)index;
+#endif
+    }
+
+    template<typename Fn>
+    static std::shared_ptr<Task> MakeTask(Fn&& fn) {
+        auto task = std::make_shared<Task>();
+        task->fn = std::forward<Fn>(fn);
+        task->context = current();
+        task->queued = Clock::now();
+        return task;
+    }
+
+    void Push(std::shared_ptr<Task> task) {
+        const int lane = (int)task->context.lane;
+        const size_t self = workerIndex();
+        Queue& queue = *queues[std::min<size_t>(self, workerCount)];
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.lanes[lane].push_back(std::move(task));
+        }
+        queued[lane].fetch_add(1, std::memory_order_release);
+        epoch.fetch_add(1, std::memory_order_release);
+        epoch.notify_one();
+    }
+
+    // Highest lane first; within a lane the own deque's back, then the
+    // front of every other deque.
+    std::shared_ptr<Task> Find(size_t self) {
+        for (int lane = 0; lane < LANES; ++lane) {
+            if (queued[lane].load(std::memory_order_acquire) == 0) continue;
+            for (size_t k = 0; k < queues.size(); ++k) {
+                const size_t q = (self + k) % queues.size();
+                Queue& queue = *queues[q];
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                auto& deque = queue.lanes[lane];
+                if (deque.empty()) continue;
+                std::shared_ptr<Task> task;
+                if (k == 0) {
+                    task = std::move(deque.back());
+                    deque.pop_back();
+                } else {
+                    task = std::move(deque.front());
+                    deque.pop_front();
+                }
+                queued[lane].fetch_sub(1, std::memory_order_relaxed);
+                return task;
+            }
+        }
+        return nullptr;
+    }
+
+    void WorkerLoop(size_t self) {
+        workerIndex() = self;
+        while (true) {
+            const uint64_t seen = epoch.load(std::memory_order_acquire);
+            if (stopping.load(std::memory_order_acquire)) return;
+            if (std::shared_ptr<Task> task = Find(self)) {
+                // A waiting Group may already have run it
+                if (!task->claimed.exchange(true, std::memory_order_acq_rel)) Execute(*task);
+                continue;
+            }
+            epoch.wait(seen, std::memory_order_acquire);
+        }
+    }
+
+    static void Execute(Task& task) {
+        const Context saved = current();
+        current() = task.context;
+        const Clock::time_point start = Clock::now();
+        task.fn();
+        const Clock::time_point end = Clock::now();
+        current() = saved;
+        Record(task.context, std::chrono::duration<double, std::milli>(end - start).count(),
+               std::chrono::duration<double, std::milli>(start - task.queued).count());
+        task.fn = nullptr;  // release captures before waking the waiter
+        task.done.store(true, std::memory_order_release);
+        task.done.notify_all();
+    }
+
+    static void Record(const Context& context, double runMs, double waitMs) {
+        StatsBlock& block = stats();
+        std::lock_guard<std::mutex> lock(block.mutex);
+        auto it = std::find_if(block.entries.begin(), block.entries.end(), [&](const StatsBlock::Entry& e) {
+            return e.lane == context.lane && (e.label == context.label || std::strcmp(e.label, context.label) == 0);
+        });
+        if (it == block.entries.end()) {
+            block.entries.push_back({ context.label, context.lane, 0, 0.0, 0.0, 0.0 });
+            it = block.entries.end() - 1;
+        }
+        ++it->count;
+        it->runMs += runMs;
+        it->maxMs = std::max(it->maxMs, runMs);
+        it->waitMs += waitMs;
+    }
+
+    const unsigned workerCount;
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> threads;
+    std::atomic<int> queued[LANES] = {};
+    std::atomic<uint64_t> epoch{0};
+    std::atomic<bool> stopping{false};
+};
@@ -3,12 +3,38 @@
 #include <vector>
 #include <cstdio>
 #include <iostream>
+#include <cstring>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include <GL/glew.h>
 
 class VideoExporter {
     FILE* ffmpegPipe = nullptr;
     int width, height;
     GLuint pbo; 
+    std::vector<uint8_t> frame;  // flipped copy the writer thread streams to ffmpeg
+
+    // The pipe write blocks while ffmpeg encodes, so it gets a thread of
+    // its own rather than a pool worker. One frame in flight at a time
+    // keeps frames in order.
+    std::thread writer;
+    std::mutex mutex;
+    std::condition_variable changed;
+    bool queued = false, stopping = false;
+
+    void WriterLoop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            changed.wait(lock, [this]() { return queued || stopping; });
+            if (!queued) return;
+            lock.unlock();
+            fwrite(frame.data(), 1, frame.size(), ffmpegPipe);
+            lock.lock();
+            queued = false;
+            changed.notify_all();
+        }
+    }
 
 public:
     VideoExporter(int w, int h, int fps) : width(w), height(h) {
@@ -35,9 +61,18 @@ public:
         // without knowing your exact hardware drivers.
 
         ffmpegPipe = popen(cmd.c_str(), "w");
+        if (ffmpegPipe) writer = std::thread([this]() { WriterLoop(); });
     }
 
     ~VideoExporter() {
+        if (writer.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            changed.notify_all();
+            writer.join();  // writes the frame still queued first
+        }
         if (ffmpegPipe) pclose(ffmpegPipe);
         glDeleteBuffers(1, &pbo);
     }
@@ -50,12 +85,24 @@ public:
         
         void* ptr = glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
         if (ptr) {
+            // The pipe write overlaps the next frame on the writer thread;
+            // only the row flip stays here
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [this]() { return !queued; });
+            }
             uint8_t* src = (uint8_t*)ptr;
             int stride = width * 3;
+            frame.resize((size_t)stride * height);
             for (int y = 0; y < height; ++y) {
-                fwrite(src + (height - 1 - y) * stride, 1, stride, ffmpegPipe);
+                std::memcpy(frame.data() + (size_t)y * stride, src + (size_t)(height - 1 - y) * stride, stride);
             }
             glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                queued = true;
+            }
+            changed.notify_all();
         }
         glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
     }
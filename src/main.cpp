@@ -10,14 +10,17 @@
 #include "ImGuiFileDialog.h"
 
 #include "FourierCore.hpp"
+#include "Chain.hpp"
 #include "SVGParser.hpp"
+#include "LoadPipeline.hpp"
 #include "Renderer.hpp"
 #include "VideoExporter.hpp"
+#include "Benchmark.hpp"
 
 #include <memory>
 #include <thread>
-#include <atomic>
-#include <future>
+#include <algorithm>
+#include <cstring>
 
 // --- Helper: HSV to RGB ---
 glm::vec4 HSVtoRGB(float h, float s, float v, float a) {
@@ -150,29 +153,82 @@ const char* fShaderLine = R"(#version 330 core
 out vec4 FragColor; uniform vec4 uColor; void main() { FragColor = uColor; })";
 
 // --- Async Loader ---
-struct LoadedData {
-    std::vector<glm::vec2> points;
-    std::vector<Epicycle> epis;
-};
-std::atomic<bool> isLoading{false};
-std::future<LoadedData> loadingFuture;
+// A new load cancels the one in flight instead of waiting for it. Cancelled
+// jobs wind down on their own threads; they are only waited for at exit.
+std::shared_ptr<LoadJob> loadJob;                    // load the UI follows, if any
+std::vector<std::shared_ptr<LoadJob>> cancelledJobs;
 std::string statusMessage = "Ready. Load an SVG to begin.";
+LoadPipeline loadPipeline;  // stage cache shared by every load
 
-void AsyncLoad(std::string path) {
-    isLoading = true;
-    statusMessage = "Parsing SVG...";
-    loadingFuture = std::async(std::launch::async, [path]() {
-        LoadedData data;
-        data.points = SVGParser::LoadAndSample(path, 10000); 
-        if (!data.points.empty()) {
-            data.epis = FourierTransform::ComputeDFT(data.points);
-        }
-        return data;
-    });
+void CancelLoad() {
+    if (!loadJob) return;
+    loadJob->Cancel();
+    cancelledJobs.push_back(std::move(loadJob));
+}
+
+void AsyncLoad(std::string path, LoadOptions options) {
+    CancelLoad();
+    loadJob = loadPipeline.Start(path, options);
 }
 
 // --- Main ---
 int main(int argc, char* argv[]) {
+    // --- Command Line ---
+    //   --threads N          worker threads for transforms and the task pool (0 = all cores)
+    //   --pin-threads        pin pool worker i to CPU i
+    //   --profile-tasks      print per-task pool timings at exit
+    //   --cache-dir DIR      where finished loads are cached (.ffspec files)
+    //   --no-cache           do not read or write cached loads
+    //   --bench-dft [N...]   print ComputeDFT scaling per thread count and exit
+    //   --bench-chain [N]    print per-frame epicycle chain cost per SIMD level and exit
+    //   --bench-svg [FILE...] print full vs geometry-only SVG parse time and exit
+    //   --bench-order [FILE...] print circles needed before/after subpath reordering and exit
+    //   --bench-codec [FILE...] print spectrum codec size, error and speed per bit depth and exit
+    unsigned poolThreads = 0;
+    bool pinThreads = false, profileTasks = false;
+    auto configurePool = [&]() { ThreadPool::Configure(poolThreads, pinThreads); };
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            poolThreads = (unsigned)std::max(0, std::atoi(argv[++i]));
+            Parallel::SetThreadCount(poolThreads);
+            configurePool();
+        } else if (std::strcmp(argv[i], "--pin-threads") == 0) {
+            pinThreads = true;
+            configurePool();
+        } else if (std::strcmp(argv[i], "--profile-tasks") == 0) {
+            profileTasks = true;
+        } else if (std::strcmp(argv[i], "--cache-dir") == 0 && i + 1 < argc) {
+            SpectrumCache::SetDirectory(argv[++i]);
+        } else if (std::strcmp(argv[i], "--no-cache") == 0) {
+            SpectrumCache::SetDirectory({});
+        } else if (std::strcmp(argv[i], "--bench-dft") == 0) {
+            std::vector<size_t> sizes;
+            while (i + 1 < argc && argv[i + 1][0] != '-') sizes.push_back((size_t)std::atoll(argv[++i]));
+            if (sizes.empty()) sizes = {10000, 100000};
+            Benchmark::DFTScaling(sizes);
+            return 0;
+        } else if (std::strcmp(argv[i], "--bench-chain") == 0) {
+            size_t count = (i + 1 < argc && argv[i + 1][0] != '-') ? (size_t)std::atoll(argv[++i]) : 100000;
+            Benchmark::ChainThroughput(count);
+            return 0;
+        } else if (std::strcmp(argv[i], "--bench-svg") == 0) {
+            std::vector<std::string> files;
+            while (i + 1 < argc && argv[i + 1][0] != '-') files.push_back(argv[++i]);
+            Benchmark::SVGParse(files);
+            return 0;
+        } else if (std::strcmp(argv[i], "--bench-order") == 0) {
+            std::vector<std::string> files;
+            while (i + 1 < argc && argv[i + 1][0] != '-') files.push_back(argv[++i]);
+            Benchmark::SubpathReorder(files);
+            return 0;
+        } else if (std::strcmp(argv[i], "--bench-codec") == 0) {
+            std::vector<std::string> files;
+            while (i + 1 < argc && argv[i + 1][0] != '-') files.push_back(argv[++i]);
+            Benchmark::Codec(files);
+            return 0;
+        }
+    }
+
     SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER);
     SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
     SDL_GL_SetAttribute(SDL_GL_MULTISAMPLEBUFFERS, 1);
@@ -207,15 +263,18 @@ int main(int argc, char* argv[]) {
     LineBatch gridBatch(5000); // 200x200 lines is plenty
     std::vector<glm::vec2> gridLines = GenerateGrid(5000.0f, 100.0f);
 
-    std::vector<Epicycle> epicycles;
-    std::vector<glm::vec2> pathPoints;
-    std::vector<glm::vec2> trail;
+    std::vector<Chain> chains;
+    size_t totalCircles = 0;
+    size_t distributed = SIZE_MAX;  // budget the chains were last split for
+    auto clearTrails = [&]() { for (auto& chain : chains) chain.trail.clear(); };
     std::vector<glm::vec2> currentCenters;
     std::vector<float> currentRadii;
     std::vector<glm::vec2> armSegments;
 
     // Animation State
     float time = 0.0f;
+    double simTime = 0.0;     // full-precision clock behind `time`
+    bool scrubbed = false;    // progress slider moved: rebuild the trail
     float speed = 0.05f; 
     bool paused = false;
     
@@ -231,6 +290,33 @@ int main(int argc, char* argv[]) {
     
     // Math Config
     int activeCircles = 10000; 
+    bool boundedChain = true;        // skip circles whose whole tail is sub-pixel
+    int fidelityMode = 0;            // Fidelity::Mode kept by loads
+    float fidelityRMS = 0.5f;        // path units (the path spans 1000)
+    float fidelityEnergy = 0.9999f;
+    int fidelityBand = 300;          // highest |frequency| computed
+    bool exactBezier = false;        // coefficients straight from the SVG cubics
+    bool geometryOnly = false;       // parse paths, shapes and transforms only (no styles)
+    bool separateParts = false;      // one chain per subpath
+    bool reorderSubpaths = false;    // optimize subpath order/direction of a joined outline
+    bool autoSamples = true;         // size the outline sample count to the curve
+    int sampleCount = 10000;         // outline samples when not automatic
+    std::string loadedPath;          // file behind the current chains
+    bool reapply = false;            // load settings changed: rerun the (cached) pipeline on loadedPath
+
+    auto loadOptions = [&]() {
+        LoadOptions options;
+        if (fidelityMode == (int)Fidelity::Mode::RMS) options.fidelity = Fidelity::RMS(fidelityRMS);
+        if (fidelityMode == (int)Fidelity::Mode::Energy) options.fidelity = Fidelity::Energy(fidelityEnergy);
+        if (fidelityMode == (int)Fidelity::Mode::Band) options.fidelity = Fidelity::Band(fidelityBand);
+        options.exactBezier = exactBezier;
+        options.maxFreq = fidelityBand;
+        if (geometryOnly) options.parseMode = SVGParser::ParseMode::Geometry;
+        options.separateParts = separateParts;
+        options.reorder = reorderSubpaths;
+        options.samples = autoSamples ? SVGParser::ADAPTIVE : sampleCount;
+        return options;
+    };
     
     // Colors
     bool rainbowMode = false;
@@ -257,6 +343,8 @@ int main(int argc, char* argv[]) {
     bool running = true;
 
     while (running) {
+        // Work the UI thread hands to the pool goes ahead of loads
+        ThreadPool::Scope frameScope(ThreadPool::Lane::Interactive, "frame");
         SDL_Event event;
         while (SDL_PollEvent(&event)) {
             ImGui_ImplSDL2_ProcessEvent(&event);
@@ -277,31 +365,50 @@ int main(int argc, char* argv[]) {
         }
 
         // --- Loading Logic ---
-        if (isLoading && loadingFuture.valid()) {
-            if (loadingFuture.wait_for(std::chrono::milliseconds(0)) == std::future_status::ready) {
-                LoadedData data = loadingFuture.get();
-                if (!data.points.empty()) {
-                    pathPoints = data.points;
-                    epicycles = data.epis;
-                    trail.clear();
-                    time = 0.0f;
-                    zoom = 1.0f;
-                    pan = glm::vec2(0.0f, 0.0f);
-                    activeCircles = (int)epicycles.size();
-                    statusMessage = "Loaded " + std::to_string(epicycles.size()) + " cycles.";
+        // Previews replace the chains as they arrive, so a coarse drawing
+        // animates while the load refines it; the last snapshot is final
+        cancelledJobs.erase(std::remove_if(cancelledJobs.begin(), cancelledJobs.end(),
+                                           [](const auto& job) { return job->Finished(); }),
+                            cancelledJobs.end());
+        if (loadJob) {
+            if (std::unique_ptr<LoadedData> snapshot = loadJob->Take()) {
+                LoadedData& data = *snapshot;
+                if (!data.parts.empty()) {
+                    const bool reloaded = data.path == loadedPath;  // same file: new settings or a finer preview
+                    const bool showingAll = activeCircles >= (int)totalCircles;
+                    loadedPath = data.path;
+                    chains.clear();
+                    totalCircles = 0;
+                    for (size_t i = 0; i < data.parts.size(); ++i) {
+                        if (data.spectra[i].empty()) continue;
+                        totalCircles += data.spectra[i].size();
+                        chains.emplace_back(std::move(data.parts[i]), std::move(data.spectra[i]));
+                    }
+                    distributed = SIZE_MAX;
+                    // A reload keeps the Vectors count the user picked (clamped below)
+                    if (!reloaded || showingAll) activeCircles = (int)totalCircles;
+                    scrubbed = true;  // redraw the ink up to the current time
+                    std::string cycles = std::to_string(totalCircles);
+                    if (totalCircles < data.coefficients) cycles += " of " + std::to_string(data.coefficients);
+                    statusMessage = (data.partial ? "Preview: " : "Loaded ") + cycles + " cycles" +
+                                    (chains.size() > 1 ? " in " + std::to_string(chains.size()) + " chains." : ".");
                     
-                    // Reset to Blueprint Mode
-                    showRef = true; 
-                    showCircles = false; 
-                    showArms = false; 
-                    showTrail = false;
-                    paused = true;
-                } else {
+                    if (!reloaded) {
+                        time = 0.0f;
+                        zoom = 1.0f;
+                        pan = glm::vec2(0.0f, 0.0f);
+
+                        // Reset to Blueprint Mode
+                        showRef = true; 
+                        showCircles = false; 
+                        showArms = false; 
+                        showTrail = false;
+                        paused = true;
+                    }
+                } else if (!data.partial) {
                     statusMessage = "Failed: Empty or invalid SVG.";
                 }
-                isLoading = false;
-            } else {
-                statusMessage = "Calculating DFT... ";
+                if (!data.partial) loadJob.reset();
             }
         }
 
@@ -315,7 +422,7 @@ int main(int argc, char* argv[]) {
         inkColor.a = trailOpacity;
 
         // --- Cinematic State Machine ---
-        if (cinematicMode && !epicycles.empty()) {
+        if (cinematicMode && !chains.empty()) {
             autoFollow = true;
             if (time < 0.1f) {
                 float t = time / 0.1f;
@@ -333,67 +440,122 @@ int main(int argc, char* argv[]) {
         }
 
         // --- Physics Loop ---
-        if (!epicycles.empty() && !isLoading) {
+        if (!chains.empty()) {
             currentCenters.clear(); currentRadii.clear(); armSegments.clear();
-            if (activeCircles > (int)epicycles.size()) activeCircles = (int)epicycles.size();
+            if (activeCircles > (int)totalCircles) activeCircles = (int)totalCircles;
             if (activeCircles < 1) activeCircles = 1;
 
+            // The "Vectors" budget goes to the largest circles of the whole
+            // drawing, whichever chain they belong to
+            if ((size_t)activeCircles != distributed) {
+                Chain::Distribute(chains, (size_t)activeCircles);
+                distributed = (size_t)activeCircles;
+            }
+
+            // Tip comes from the reconstructed-curve table (O(1) per lookup).
+            // Dragging "Vectors" patches it term by term instead of rebuilding.
+            {
+                ThreadPool::Scope scope("curve");
+                Parallel::For(0, chains.size(), 0, 1, [&](size_t lo, size_t hi) {
+                    for (size_t c = lo; c < hi; ++c) chains[c].curve.SetCount(chains[c].epis, chains[c].count);
+                });
+            }
+
+            // Slider, reset and reload write `time` directly
+            if ((float)simTime != time) simTime = time;
+            if (scrubbed) {
+                ThreadPool::Scope scope("trail");
+                Parallel::For(0, chains.size(), 0, 1, [&](size_t lo, size_t hi) {
+                    for (size_t c = lo; c < hi; ++c) {
+                        chains[c].trail = chains[c].curve.Trace(simTime, 0.5f, (size_t)trailLength);
+                    }
+                });
+                scrubbed = false;
+            }
+
             int subSteps = recording ? 1 : 5; 
+            const double step = recording ? speed * (1.0 / 60.0) : (speed * 0.002) / subSteps;
+            bool stepped = false;
             
             for (int s = 0; s < subSteps; ++s) {
                 if (!paused) {
-                    if (recording) {
-                        time += speed * (1.0f / 60.0f);
-                    } else {
-                        time += (speed * 0.002f) / subSteps;
-                    }
+                    simTime += step;
+                    stepped = true;
 
-                    if (time >= 1.0f) { 
-                        time -= 1.0f; 
-                        if (trailLength == 0) trail.clear(); 
+                    if (simTime >= 1.0) {
+                        simTime -= 1.0; 
+                        if (trailLength == 0) clearTrails(); 
                         
                         if (cinematicMode && recording) {
                             recording = false;
                             cinematicMode = false;
                             exporter.reset(); 
                             paused = true;    
-                            time = 0.999f;    
+                            simTime = 0.999;    
                             zoom = 1.0f;      
                             pan = glm::vec2(0,0);
                             statusMessage = "Cinematic Shot Saved Successfully!";
                         }
                     }
+                    time = (float)simTime;
                 }
-                
-                std::complex<double> tipPos(0,0);
-                for(int i=0; i<activeCircles; ++i) {
-                    tipPos += epicycles[i].evaluate(time);
-                }
-                glm::vec2 tip(tipPos.real(), tipPos.imag());
-                
-                if (autoFollow) pan = -tip;
 
-                if (!paused) {
-                    if (trail.empty() || glm::distance(trail.back(), tip) > 0.5f) {
-                        trail.push_back(tip);
-                    }
-                    if (trailLength > 0 && trail.size() > (size_t)trailLength) {
-                        trail.erase(trail.begin());
+                for (size_t c = 0; c < chains.size(); ++c) {
+                    auto& chain = chains[c];
+                    std::complex<double> tipPos = chain.curve.At(simTime);
+                    glm::vec2 tip(tipPos.real(), tipPos.imag());
+
+                    if (autoFollow && c == 0) pan = -tip;
+
+                    if (!paused) {
+                        if (chain.trail.empty() || glm::distance(chain.trail.back(), tip) > 0.5f) {
+                            chain.trail.push_back(tip);
+                        }
+                        if (trailLength > 0 && chain.trail.size() > (size_t)trailLength) {
+                            chain.trail.erase(chain.trail.begin());
+                        }
                     }
                 }
             }
-            
-            std::complex<double> currentPos(0,0);
-            for(int i=0; i<activeCircles; ++i) {
-                const auto& epi = epicycles[i];
-                glm::vec2 prevPos(currentPos.real(), currentPos.imag());
-                currentPos += epi.evaluate(time);
-                glm::vec2 newPos(currentPos.real(), currentPos.imag());
-                
-                if (activeCircles < 50 || epi.amp > 1.0f / zoom) {
-                    currentCenters.push_back(prevPos);
-                    currentRadii.push_back(epi.amp);
-                    armSegments.push_back(prevPos); armSegments.push_back(newPos);
+
+            // Arms need the phasors, but only once per frame, and only the
+            // circles whose combined tail can still move the pen by more
+            // than half a rendered pixel. Chains are independent, so they
+            // advance in parallel; the draw lists are then filled in order.
+            const double pixel = (1000.0 / zoom) / RENDER_H;
+            std::vector<size_t> chainCounts(chains.size());
+            {
+                ThreadPool::Scope scope("chain");
+                Parallel::For(0, chains.size(), 0, 1, [&](size_t lo, size_t hi) {
+                    for (size_t c = lo; c < hi; ++c) {
+                        auto& chain = chains[c];
+                        size_t chainCount = chain.count;
+                        if (boundedChain && activeCircles >= 50) {
+                            chainCount = std::max<size_t>(1, chain.phasors.BoundedCount(chain.count, 0.5 * pixel));
+                        }
+                        if (stepped) chain.phasors.Advance(step * subSteps, chainCount);
+                        chain.phasors.Follow(simTime);
+                        chain.phasors.ComputeChain(chainCount);
+                        chainCounts[c] = chainCount;
+                    }
+                });
+            }
+            for (size_t c = 0; c < chains.size(); ++c) {
+                const auto& chain = chains[c];
+                const size_t chainCount = chainCounts[c];
+                const double* chainX = chain.phasors.ChainRe();
+                const double* chainY = chain.phasors.ChainIm();
+                glm::vec2 prevPos(0.0f, 0.0f);
+                for(int i=0; i<(int)chainCount; ++i) {
+                    const auto& epi = chain.epis[i];
+                    glm::vec2 newPos((float)chainX[i], (float)chainY[i]);
+
+                    if (activeCircles < 50 || epi.amp > 1.0f / zoom) {
+                        currentCenters.push_back(prevPos);
+                        currentRadii.push_back(epi.amp);
+                        armSegments.push_back(prevPos); armSegments.push_back(newPos);
+                    }
+                    prevPos = newPos;
                 }
             }
         }
@@ -421,17 +583,21 @@ int main(int argc, char* argv[]) {
         }
 
         // 1. Ghost Reference
-        if (showRef && !pathPoints.empty()) {
+        if (showRef && !chains.empty()) {
             glLineWidth(1.0f);
             lineShader.Use(); lineShader.SetMat4("uProjection", proj); lineShader.SetMat4("uView", view);
-            pathRenderer.UpdateAndDraw(pathPoints, lineShader, glm::vec4(0.2, 0.2, 0.2, refOpacity));
+            for (const auto& chain : chains) {
+                pathRenderer.UpdateAndDraw(chain.points, lineShader, glm::vec4(0.2, 0.2, 0.2, refOpacity));
+            }
         }
 
         // 2. Ink Trail
-        if (showTrail && !trail.empty()) {
+        if (showTrail && !chains.empty()) {
             glLineWidth(strokeWidth);
             lineShader.Use(); lineShader.SetMat4("uProjection", proj); lineShader.SetMat4("uView", view);
-            trailRenderer.UpdateAndDraw(trail, lineShader, inkColor);
+            for (const auto& chain : chains) {
+                if (!chain.trail.empty()) trailRenderer.UpdateAndDraw(chain.trail, lineShader, inkColor);
+            }
         }
 
         // 3. Epicycles
@@ -465,16 +631,6 @@ int main(int argc, char* argv[]) {
         ImGui_ImplSDL2_NewFrame();
         ImGui::NewFrame();
 
-        if (isLoading) {
-            if (!ImGui::IsPopupOpen("Loading")) ImGui::OpenPopup("Loading");
-        }
-        bool open = true;
-        if (ImGui::BeginPopupModal("Loading", &open, ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoMove)) {
-            ImGui::Text("%s", statusMessage.c_str());
-            if (!isLoading) ImGui::CloseCurrentPopup();
-            ImGui::EndPopup();
-        }
-
         ImGui::Begin("Fourier Forge", nullptr, ImGuiWindowFlags_AlwaysAutoResize);
         
         if (ImGui::Button(" Load SVG ")) {
@@ -483,6 +639,54 @@ int main(int argc, char* argv[]) {
         }
         ImGui::SameLine();
         ImGui::TextDisabled("%s", statusMessage.c_str());
+        if (loadJob) {
+            const LoadJob::Progress progress = loadJob->Status();
+            std::string label = LoadJob::StageName(progress.stage);
+            if (progress.total > 0) label += " " + std::to_string(progress.done) + "/" + std::to_string(progress.total);
+            ImGui::ProgressBar(progress.total > 0 ? (float)progress.done / progress.total : 0.0f, ImVec2(250, 0),
+                               label.c_str());
+            ImGui::SameLine();
+            if (ImGui::Button("Cancel##Load")) {
+                CancelLoad();
+                statusMessage = chains.empty() ? "Load cancelled." : "Load cancelled; keeping the preview.";
+            }
+        }
+
+        // Load settings: changing one reruns the pipeline on the current
+        // file, from the first stage it affects (sliders on release)
+        ImGui::Text("Keep:"); ImGui::SameLine();
+        reapply |= ImGui::RadioButton("All", &fidelityMode, (int)Fidelity::Mode::All); ImGui::SameLine();
+        reapply |= ImGui::RadioButton("RMS Error", &fidelityMode, (int)Fidelity::Mode::RMS); ImGui::SameLine();
+        reapply |= ImGui::RadioButton("Energy", &fidelityMode, (int)Fidelity::Mode::Energy); ImGui::SameLine();
+        reapply |= ImGui::RadioButton("Band", &fidelityMode, (int)Fidelity::Mode::Band);
+        if (fidelityMode == (int)Fidelity::Mode::RMS) {
+            ImGui::SliderFloat("Max RMS##Fidelity", &fidelityRMS, 0.01f, 10.0f, "%.2f", ImGuiSliderFlags_Logarithmic);
+            reapply |= ImGui::IsItemDeactivatedAfterEdit();
+        } else if (fidelityMode == (int)Fidelity::Mode::Energy) {
+            ImGui::SliderFloat("Fraction##Fidelity", &fidelityEnergy, 0.9f, 1.0f, "%.5f");
+            reapply |= ImGui::IsItemDeactivatedAfterEdit();
+        }
+        if (fidelityMode == (int)Fidelity::Mode::Band || exactBezier) {
+            ImGui::SliderInt("Max Freq##Fidelity", &fidelityBand, 1, 5000, "%d", ImGuiSliderFlags_Logarithmic);
+            reapply |= ImGui::IsItemDeactivatedAfterEdit();
+        }
+        reapply |= ImGui::Checkbox("Auto Samples", &autoSamples);
+        if (!autoSamples) {
+            ImGui::SameLine();
+            ImGui::SliderInt("Samples", &sampleCount, SVGParser::ADAPTIVE_MIN, SVGParser::ADAPTIVE_MAX, "%d",
+                             ImGuiSliderFlags_Logarithmic);
+            reapply |= ImGui::IsItemDeactivatedAfterEdit();
+        }
+        reapply |= ImGui::Checkbox("Exact Bezier", &exactBezier); ImGui::SameLine();
+        reapply |= ImGui::Checkbox("Geometry Only", &geometryOnly); ImGui::SameLine();
+        reapply |= ImGui::Checkbox("Separate Parts", &separateParts); ImGui::SameLine();
+        reapply |= ImGui::Checkbox("Reorder Subpaths", &reorderSubpaths);
+        if (reapply) {
+            // The file being loaded if any, else the one on screen
+            const std::string target = loadJob ? loadJob->Path() : loadedPath;
+            if (!target.empty()) AsyncLoad(target, loadOptions());
+            reapply = false;
+        }
         ImGui::Separator();
 
         // PLAYBACK
@@ -491,14 +695,14 @@ int main(int argc, char* argv[]) {
         ImGui::SameLine();
         if (ImGui::Button(" RESET ")) { 
             time = 0.0f; 
-            trail.clear(); 
+            clearTrails(); 
             paused = true;
             // Blueprint Mode
             showRef = true; showCircles = false; showArms = false; showTrail = false;
         }
         ImGui::SameLine();
         ImGui::PushItemWidth(150);
-        ImGui::SliderFloat("##Progress", &time, 0.0f, 1.0f, "%.2f");
+        if (ImGui::SliderFloat("##Progress", &time, 0.0f, 1.0f, "%.2f")) scrubbed = true;
         ImGui::PopItemWidth();
         ImGui::SliderFloat("Speed", &speed, 0.0f, 2.0f, "%.3f", ImGuiSliderFlags_Logarithmic);
 
@@ -551,8 +755,37 @@ int main(int argc, char* argv[]) {
                 if(ImGui::Button("Reset View")) { zoom=1.0f; pan=glm::vec2(0,0); autoFollow=false; }
                 
                 ImGui::Separator();
-                int maxE = (int)epicycles.size();
+                int maxE = (int)totalCircles;
                 ImGui::SliderInt("Vectors", &activeCircles, 1, maxE);
+                ImGui::Checkbox("Sub-pixel Culling", &boundedChain);
+                ImGui::EndTabItem();
+            }
+
+            // --- TAB: PROFILE ---
+            if (ImGui::BeginTabItem("Profile")) {
+                ImGui::Dummy(ImVec2(0, 5));
+                ImGui::Text("Task pool: %u workers", ThreadPool::Shared().Workers());
+                ImGui::SameLine();
+                if (ImGui::Button("Reset##Profile")) ThreadPool::ResetProfile();
+                if (ImGui::BeginTable("Tasks", 6, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+                    ImGui::TableSetupColumn("Task");
+                    ImGui::TableSetupColumn("Lane");
+                    ImGui::TableSetupColumn("Count");
+                    ImGui::TableSetupColumn("Total ms");
+                    ImGui::TableSetupColumn("Max ms");
+                    ImGui::TableSetupColumn("Avg wait ms");
+                    ImGui::TableHeadersRow();
+                    for (const auto& task : ThreadPool::Profile()) {
+                        ImGui::TableNextRow();
+                        ImGui::TableNextColumn(); ImGui::Text("%s", task.label.c_str());
+                        ImGui::TableNextColumn(); ImGui::Text("%s", ThreadPool::LaneName(task.lane));
+                        ImGui::TableNextColumn(); ImGui::Text("%llu", (unsigned long long)task.count);
+                        ImGui::TableNextColumn(); ImGui::Text("%.1f", task.runMs);
+                        ImGui::TableNextColumn(); ImGui::Text("%.2f", task.maxMs);
+                        ImGui::TableNextColumn(); ImGui::Text("%.3f", task.waitMs / std::max<uint64_t>(1, task.count));
+                    }
+                    ImGui::EndTable();
+                }
                 ImGui::EndTabItem();
             }
 
@@ -561,11 +794,11 @@ int main(int argc, char* argv[]) {
                 ImGui::Dummy(ImVec2(0, 5));
                 ImGui::TextColored(ImVec4(1, 0.8f, 0, 1), "Cinematic Auto-Render");
                 if (ImGui::Button("START CINEMATIC SHOT", ImVec2(-1, 40))) {
-                    if (!epicycles.empty()) {
+                    if (!chains.empty()) {
                         cinematicMode = true;
                         recording = true;
                         exporter = std::make_unique<VideoExporter>(RENDER_W, RENDER_H, 60);
-                        time = 0.0f; trail.clear(); paused = false; autoFollow = true; trailLength = 0; 
+                        time = 0.0f; clearTrails(); paused = false; autoFollow = true; trailLength = 0; 
                         
                         // Force Enable Drawing
                         showRef = false; showCircles = true; showArms = true; showTrail = true;
@@ -578,7 +811,7 @@ int main(int argc, char* argv[]) {
                     recording = !recording;
                     if (recording) {
                         exporter = std::make_unique<VideoExporter>(RENDER_W, RENDER_H, 60);
-                        time = 0.0f; trail.clear(); showTrail = true;
+                        time = 0.0f; clearTrails(); showTrail = true;
                     } else exporter.reset();
                 }
                 if (recording) ImGui::TextColored(ImVec4(1, 0, 0, 1), "RECORDING...");
@@ -591,7 +824,7 @@ int main(int argc, char* argv[]) {
         ImVec2 minSize(800, 600); ImVec2 maxSize(FLT_MAX, FLT_MAX);
         if (IGFD::FileDialog::Instance()->Display("ChooseFile", ImGuiWindowFlags_NoCollapse, minSize, maxSize)) {
             if (IGFD::FileDialog::Instance()->IsOk()) {
-                AsyncLoad(IGFD::FileDialog::Instance()->GetFilePathName());
+                AsyncLoad(IGFD::FileDialog::Instance()->GetFilePathName(), loadOptions());
             }
             IGFD::FileDialog::Instance()->Close();
         }
@@ -602,7 +835,15 @@ int main(int argc, char* argv[]) {
         SDL_GL_SwapWindow(window);
     }
 
-    if(isLoading && loadingFuture.valid()) loadingFuture.wait();
+    CancelLoad();
+    for (const auto& job : cancelledJobs) job->Wait();
+    if (profileTasks) {
+        std::cout << "Task profile (label, lane, count, total ms, max ms, total wait ms):\n";
+        for (const auto& task : ThreadPool::Profile()) {
+            std::cout << "  " << task.label << ", " << ThreadPool::LaneName(task.lane) << ", " << task.count << ", " << task.runMs << ", "
+                      << task.maxMs << ", " << task.waitMs << "\n";
+        }
+    }
     exporter.reset();
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplSDL2_Shutdown();